@@ -0,0 +1,90 @@
+/*
+  Sleeping until the next job with RV-3028-C7 Real Time Clock
+  License: This code is public domain but you buy me a beer if you use this and we meet someday (Beerware license).
+  https://github.com/constiko/RV-3028_C7-Arduino_Library
+
+  This example shows how to let the RTC wake up the MCU with the countdown timer or the alarm.
+  Connect the INT pin of the RTC to an interrupt capable pin of your board (pin 2 on Arduino Uno).
+  sleepFor() picks the wake source, calls sleepUntilINT() and returns why the MCU woke up.
+  Open the serial monitor at 115200 baud
+*/
+
+#include <RV-3028-C7.h>
+#include <RV-3028-C7_Sleep.h>
+#if defined(__AVR__)
+#include <avr/sleep.h>
+#endif
+
+#define INT_PIN 2
+
+RV3028 rtc;
+RV3028_Sleep planner(rtc);
+
+void wakeISR() {
+  detachInterrupt(digitalPinToInterrupt(INT_PIN));
+}
+
+//Sleep hook: returns when INT goes low
+void sleepUntilINT(void * context) {
+  Serial.flush();
+#if defined(__AVR__)
+  set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+  noInterrupts();
+  sleep_enable();
+  attachInterrupt(digitalPinToInterrupt(INT_PIN), wakeISR, LOW);
+  interrupts();
+  sleep_cpu();
+  sleep_disable();
+#else
+  while (digitalRead(INT_PIN) == HIGH);
+#endif
+}
+
+void setup() {
+
+  Serial.begin(115200);
+  while (!Serial);
+  Serial.println("Sleep - RTC Example");
+
+  Wire.begin();
+  if (rtc.begin() == false) {
+    Serial.println("Something went wrong, check wiring");
+    while (1);
+  }
+  else
+    Serial.println("RTC online!");
+
+  //INT is open drain and active low
+  pinMode(INT_PIN, INPUT_PULLUP);
+  planner.setSleepHook(sleepUntilINT);
+}
+
+void loop() {
+
+  Serial.println("Working...");
+
+  //Countdown timer with 1Hz, for more than 4095 seconds the 1/60Hz timer, for more than 68 hours the alarm
+  uint8_t cause = planner.sleepFor(30);
+  //uint8_t cause = planner.sleepUntil(1735689600);  //Until a UNIX Time of the RTC
+
+  if (cause == SLEEP_WAKE_TIMER || cause == SLEEP_WAKE_ALARM)
+    Serial.println("Woken up on time");
+  else if (cause == SLEEP_WAKE_POWER)
+    Serial.println("Woken up by a power failure");
+  else if (cause == SLEEP_WAKE_ERROR)
+    Serial.println("RTC failed");
+  else
+    Serial.println("Woken up early");
+
+  //Without sleepFor(): arm the wake source, sleep yourself and ask for the cause
+  planner.arm(5);
+  sleepUntilINT(NULL);
+  uint32_t elapsed;
+  cause = planner.wakeCause(&elapsed);
+  planner.disarm();
+  Serial.print("Wake cause ");
+  Serial.print(cause);
+  Serial.print(" after ");
+  Serial.print(elapsed);
+  Serial.println(" s");
+}
@@ -0,0 +1,136 @@
+/*
+  Benchmark of the RV-3028-C7 Arduino Library
+  License: This code is public domain but you buy me a beer if you use this and we meet someday (Beerware license).
+  https://github.com/constiko/RV-3028_C7-Arduino_Library
+
+  This example measures how long the conversion functions, the string functions and the
+  most important bus functions of the library take on your board.
+  Apart from begin() it only reads from the RTC, so it doesn't change the settings of the unit.
+  The bus transaction budget of every function is checked on a PC by extras/test (make test).
+  Open the serial monitor at 115200 baud
+*/
+
+#include <RV-3028-C7.h>
+
+RV3028 rtc;
+
+//Number of calls per measurement. Bus functions are slow, so they run less often.
+#define KERNEL_RUNS	1000
+#define BUS_RUNS	20
+
+//Keeps the compiler from optimizing the measured calls away
+volatile uint8_t sink;
+
+void printResult(const char * name, unsigned long start, unsigned int runs)
+{
+  unsigned long duration = micros() - start;
+  Serial.print(name);
+  Serial.print(": ");
+  Serial.print((float)duration / runs);
+  Serial.println(" us");
+}
+
+void setup() {
+
+  Serial.begin(115200);
+  while (!Serial);
+  Serial.println("Benchmark - RTC Example");
+
+  Wire.begin();
+  unsigned long start = micros();
+  if (rtc.begin() == false) {
+    Serial.println("Something went wrong, check wiring");
+    while (1);
+  }
+  else
+    Serial.println("RTC online!");
+  printResult("begin()", start, 1);
+  Serial.println();
+
+  //CONVERSION FUNCTIONS
+  Serial.println("Conversion functions (no bus access):");
+
+  start = micros();
+  for (unsigned int i = 0; i < KERNEL_RUNS; i++)
+    sink = rtc.BCDtoDEC(i % 0x9A);
+  printResult("BCDtoDEC()", start, KERNEL_RUNS);
+
+  start = micros();
+  for (unsigned int i = 0; i < KERNEL_RUNS; i++)
+    sink = rtc.DECtoBCD(i % 100);
+  printResult("DECtoBCD()", start, KERNEL_RUNS);
+
+  start = micros();
+  for (unsigned int i = 0; i < KERNEL_RUNS; i++)
+    sink = RV3028::weekdayFromDate(2000 + i % 100, 1 + i % 12, 1 + i % 28);
+  printResult("weekdayFromDate()", start, KERNEL_RUNS);
+  Serial.println();
+
+  //STRING FUNCTIONS
+  //They format the time read by updateTime() without bus access
+  Serial.println("String functions (no bus access):");
+  rtc.updateTime();
+
+  start = micros();
+  for (unsigned int i = 0; i < KERNEL_RUNS; i++)
+    sink = rtc.stringDateUSA()[0];
+  printResult("stringDateUSA()", start, KERNEL_RUNS);
+
+  start = micros();
+  for (unsigned int i = 0; i < KERNEL_RUNS; i++)
+    sink = rtc.stringDate()[0];
+  printResult("stringDate()", start, KERNEL_RUNS);
+
+  start = micros();
+  for (unsigned int i = 0; i < KERNEL_RUNS; i++)
+    sink = rtc.stringTime()[0];
+  printResult("stringTime()", start, KERNEL_RUNS);
+
+  start = micros();
+  for (unsigned int i = 0; i < KERNEL_RUNS; i++)
+    sink = rtc.stringTimeStamp()[0];
+  printResult("stringTimeStamp()", start, KERNEL_RUNS);
+
+  //12/24 hour conversion of the time read by updateTime()
+  start = micros();
+  for (unsigned int i = 0; i < KERNEL_RUNS; i++)
+    sink = rtc.getDateTime().hours;
+  printResult("getDateTime()", start, KERNEL_RUNS);
+  Serial.println();
+
+  //BUS FUNCTIONS
+  Serial.println("Bus functions:");
+
+  start = micros();
+  for (unsigned int i = 0; i < BUS_RUNS; i++)
+    rtc.updateTime();
+  printResult("updateTime()", start, BUS_RUNS);
+
+  start = micros();
+  for (unsigned int i = 0; i < BUS_RUNS; i++)
+    sink = rtc.getUNIX();
+  printResult("getUNIX()", start, BUS_RUNS);
+
+  start = micros();
+  for (unsigned int i = 0; i < BUS_RUNS; i++)
+    sink = rtc.is12Hour();
+  printResult("is12Hour()", start, BUS_RUNS);
+
+  RV3028_Alarm alarm;
+  start = micros();
+  for (unsigned int i = 0; i < BUS_RUNS; i++)
+    rtc.getAlarm(alarm);
+  printResult("getAlarm()", start, BUS_RUNS);
+
+  //EEPROM functions wait for the EEPROM, so they run only once
+  start = micros();
+  sink = rtc.readConfigEEPROM_RAMmirror(EEPROM_Backup_Register);
+  printResult("readConfigEEPROM_RAMmirror()", start, 1);
+
+  Serial.println();
+  Serial.println("Benchmark done");
+}
+
+void loop() {
+
+}
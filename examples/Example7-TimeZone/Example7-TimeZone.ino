@@ -0,0 +1,58 @@
+/*
+  Local time with time zone and daylight saving time at RV-3028-C7 Real Time Clock
+  License: This code is public domain but you buy me a beer if you use this and we meet someday (Beerware license).
+  https://github.com/constiko/RV-3028_C7-Arduino_Library
+
+  This example shows how to keep the RTC in UTC and print the local time.
+  All daylight saving time transitions are calculated once at startup,
+  afterwards each conversion is a single table lookup.
+  Open the serial monitor at 115200 baud
+*/
+
+#include <RV-3028-C7.h>
+#include <RV-3028-C7_TimeZone.h>
+
+RV3028 rtc;
+RV3028_TimeZone timeZone;
+
+//POSIX TZ string of your time zone, e.g. "EST5EDT,M3.2.0,M11.1.0" for US Eastern
+const char * tz = "CET-1CEST,M3.5.0,M10.5.0/3";
+
+void setup() {
+
+  Serial.begin(115200);
+  while (!Serial);
+  Serial.println("Time Zone - RTC Example");
+
+  Wire.begin();
+  if (rtc.begin() == false) {
+    Serial.println("Something went wrong, check wiring");
+    while (1);
+  }
+  else
+    Serial.println("RTC online!");
+
+  //Transitions of 20 years starting 2020
+  if (timeZone.begin(tz, 2020, 20) == false) {
+    Serial.println("Invalid time zone");
+    while (1);
+  }
+}
+
+void loop() {
+
+  if (rtc.updateTime() == false) //Updates the time variables from RTC
+  {
+    Serial.print("RTC failed to update");
+  } else {
+    Serial.print("UTC:   ");
+    Serial.println(rtc.stringTimeStamp());
+
+    RV3028_DateTime local = RV3028::UNIXtoDateTime(timeZone.toLocal(rtc));
+    char localTime[21];
+    sprintf(localTime, "%04u-%02u-%02u  %02u:%02u:%02u", local.year, local.month, local.date, local.hours, local.minutes, local.seconds);
+    Serial.print("Local: ");
+    Serial.println(localTime);
+  }
+  delay(1000);
+}
@@ -0,0 +1,48 @@
+/*
+  Counting pulses on the EVI pin of RV-3028-C7 Real Time Clock
+  License: This code is public domain but you buy me a beer if you use this and we meet someday (Beerware license).
+  https://github.com/constiko/RV-3028_C7-Arduino_Library
+
+  This example shows how to let the RTC count pulses (e.g. of a flow or energy meter) on the EVI pin.
+  The RTC counts while the MCU sleeps, the MCU only has to read the counter at least every 255 pulses.
+  Open the serial monitor at 115200 baud
+*/
+
+#include <RV-3028-C7.h>
+
+RV3028 rtc;
+
+void setup() {
+
+  Serial.begin(115200);
+  while (!Serial);
+  Serial.println("Pulse Counter - RTC Example");
+
+  Wire.begin();
+  if (rtc.begin() == false) {
+    Serial.println("Something went wrong, check wiring");
+    while (1);
+  }
+  else
+    Serial.println("RTC online!");
+
+  //Count rising edges on EVI with 15.6ms filtering time
+  rtc.enablePulseCounter(true, EVENT_FILTER_15_6MS);
+  //rtc.disablePulseCounter();  //Stops counting
+}
+
+void loop() {
+
+  if (rtc.updatePulseCounter() == false) //Reads counter and time of the last pulse in one burst
+  {
+    Serial.println("RTC failed to update");
+  } else {
+    Serial.print("Pulses: ");
+    Serial.print(rtc.getPulseCount());
+    Serial.print("   Last pulse: ");
+    Serial.print(rtc.getPulseTime());
+    Serial.print("   Pulses per second: ");
+    Serial.println(rtc.getPulseRate());
+  }
+  delay(10000);
+}
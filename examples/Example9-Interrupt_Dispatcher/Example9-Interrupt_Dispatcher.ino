@@ -0,0 +1,71 @@
+/*
+  Handling all interrupts of RV-3028-C7 Real Time Clock with the INT pin
+  License: This code is public domain but you buy me a beer if you use this and we meet someday (Beerware license).
+  https://github.com/constiko/RV-3028_C7-Arduino_Library
+
+  This example shows how to handle the interrupts of the RTC without polling.
+  Connect the INT pin of the RTC to an interrupt capable pin of your board (pin 2 on Arduino Uno).
+  The ISR only marks the interrupt as pending, service() reads and clears the status register
+  (one read and one write per set of flags, plus a final read that finds no flag left)
+  and calls the handler of every source that fired.
+  Open the serial monitor at 115200 baud
+*/
+
+#include <RV-3028-C7.h>
+#include <RV-3028-C7_Dispatcher.h>
+
+#define INT_PIN 2
+
+RV3028 rtc;
+RV3028_Dispatcher dispatcher(rtc);
+
+void rtcISR() {
+  dispatcher.interrupt();
+}
+
+void onAlarm(uint8_t source) {
+  Serial.println("ALARM!!!!");
+}
+
+void setup() {
+
+  Serial.begin(115200);
+  while (!Serial);
+  Serial.println("Interrupt Dispatcher - RTC Example");
+
+  Wire.begin();
+  if (rtc.begin() == false) {
+    Serial.println("Something went wrong, check wiring");
+    while (1);
+  }
+  else
+    Serial.println("RTC online!");
+
+  dispatcher.attachHandler(STATUS_AF, onAlarm);
+
+  //INT is open drain and active low
+  pinMode(INT_PIN, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(INT_PIN), rtcISR, FALLING);
+
+  //Alarm every hour when minutes are 0
+  RV3028_Alarm alarm = { 0, 0, 0, false, 6, true };
+  rtc.setAlarm(alarm);
+}
+
+void loop() {
+
+  //Reads the status register only if the INT pin fired
+  dispatcher.service();
+
+  //Events of all sources, e.g. for another task or for logging
+  RV3028_Event event;
+  while (dispatcher.readEvent(event)) {
+    Serial.print("Interrupt flag ");
+    Serial.print(event.source);
+    Serial.print(" at ");
+    Serial.print(event.millis);
+    Serial.println(" ms");
+  }
+
+  //The MCU could sleep here until INT fires
+}
@@ -0,0 +1,140 @@
+/******************************************************************************
+Wire.cpp
+RV-3028-C7 Arduino Library - host test
+
+This code is released under the [MIT License](http://opensource.org/licenses/MIT).
+Please review the LICENSE.md file included with this example.
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#include "Wire.h"
+#include "RV-3028-C7.h"
+#include <chrono>
+#include <thread>
+
+TwoWire Wire;
+
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+unsigned long millis()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+unsigned long micros()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void delay(unsigned long ms)
+{
+	(void)ms; //The simulated RTC is never busy
+}
+
+TwoWire::TwoWire()
+{
+	powerOn();
+}
+
+void TwoWire::powerOn()
+{
+	memset(regs, 0, sizeof(regs));
+	memset(eeprom, 0, sizeof(eeprom));
+	regs[RV3028_DATE] = 0x01;
+	regs[RV3028_MONTHS] = 0x01;
+	regs[RV3028_STATUS] = 1 << STATUS_PORF;
+	regs[RV3028_ID] = 0x30;
+	eeprom[EEPROM_Backup_Register] = 0x10; //Factory setting: FEDE set
+	memcpy(&regs[EEPROM_Config_First], &eeprom[EEPROM_Config_First], EEPROM_Config_Last - EEPROM_Config_First + 1);
+	transactions = 0;
+	eepromUpdates = 0;
+	_rxLength = 0;
+	_rxPosition = 0;
+}
+
+void TwoWire::beginTransmission(uint8_t address)
+{
+	_address = address;
+	_pointerSet = false;
+	_written = 0;
+}
+
+size_t TwoWire::write(uint8_t value)
+{
+	if (++_written > WIRE_BUFFER_LENGTH) return 0;
+	if (_address != RV3028_ADDR) return 1;
+
+	if (_pointerSet == false)
+	{
+		_pointer = value;
+		_pointerSet = true;
+	}
+	else
+		writeRegister(_pointer++, value);
+	return 1;
+}
+
+uint8_t TwoWire::endTransmission()
+{
+	transactions++;
+	if (_written > WIRE_BUFFER_LENGTH) return 1; //Data too long
+	if (_address != RV3028_ADDR) return 2; //Address not acknowledged
+	return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity)
+{
+	transactions++;
+	_rxLength = 0;
+	_rxPosition = 0;
+	if (address != RV3028_ADDR) return 0;
+	if (quantity > WIRE_BUFFER_LENGTH) quantity = WIRE_BUFFER_LENGTH;
+
+	for (uint8_t i = 0; i < quantity; i++)
+		_rxBuffer[i] = regs[(uint8_t)(_pointer + i)];
+	_pointer += quantity;
+	_rxLength = quantity;
+	return quantity;
+}
+
+int TwoWire::available()
+{
+	return _rxLength - _rxPosition;
+}
+
+int TwoWire::read()
+{
+	if (_rxPosition >= _rxLength) return -1;
+	return _rxBuffer[_rxPosition++];
+}
+
+void TwoWire::writeRegister(uint8_t addr, uint8_t value)
+{
+	switch (addr)
+	{
+	case RV3028_TIMERSTAT_0:
+	case RV3028_TIMERSTAT_1:
+	case RV3028_ID:
+		return; //Read only
+	case RV3028_STATUS:
+		//Flags are cleared by writing 0, EEBUSY is read only
+		regs[addr] &= value | 1 << STATUS_EEBUSY;
+		return;
+	case RV3028_EEPROM_CMD:
+		regs[addr] = value;
+		if (value == EEPROMCMD_Update)
+		{
+			memcpy(&eeprom[EEPROM_Config_First], &regs[EEPROM_Config_First], EEPROM_Config_Last - EEPROM_Config_First + 1);
+			eepromUpdates++;
+		}
+		else if (value == EEPROMCMD_Refresh)
+			memcpy(&regs[EEPROM_Config_First], &eeprom[EEPROM_Config_First], EEPROM_Config_Last - EEPROM_Config_First + 1);
+		else if (value == EEPROMCMD_WriteSingle)
+			eeprom[regs[RV3028_EEPROM_ADDR]] = regs[RV3028_EEPROM_DATA];
+		else if (value == EEPROMCMD_ReadSingle)
+			regs[RV3028_EEPROM_DATA] = eeprom[regs[RV3028_EEPROM_ADDR]];
+		return;
+	default:
+		regs[addr] = value;
+	}
+}
@@ -0,0 +1,52 @@
+/******************************************************************************
+Wire.h
+RV-3028-C7 Arduino Library - host test
+
+Fake I2C bus with a simulated RV-3028-C7 register file and EEPROM.
+Counts the bus transactions (endTransmission() and requestFrom()) for the budget test.
+The clock does not run, the tests set the time registers themselves.
+
+This code is released under the [MIT License](http://opensource.org/licenses/MIT).
+Please review the LICENSE.md file included with this example.
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#pragma once
+
+#include "Arduino.h"
+
+#define WIRE_BUFFER_LENGTH 32 //Same as the AVR Wire library
+
+class TwoWire
+{
+public:
+	TwoWire();
+
+	void begin() {}
+	void beginTransmission(uint8_t address);
+	size_t write(uint8_t value);
+	uint8_t endTransmission();
+	uint8_t requestFrom(uint8_t address, uint8_t quantity);
+	int available();
+	int read();
+
+	//Simulated RV-3028-C7
+	void powerOn(); //Registers and EEPROM after the first power up, PORF set
+	uint8_t regs[256];
+	uint8_t eeprom[256]; //User EEPROM 0x00 to 0x2A, configuration EEPROM 0x30 to 0x37
+	unsigned long transactions;
+	unsigned long eepromUpdates;
+
+private:
+	void writeRegister(uint8_t addr, uint8_t value);
+
+	uint8_t _address;
+	uint8_t _pointer;
+	bool _pointerSet;
+	uint8_t _written; //Bytes after beginTransmission()
+	uint8_t _rxBuffer[WIRE_BUFFER_LENGTH];
+	uint8_t _rxLength;
+	uint8_t _rxPosition;
+};
+
+extern TwoWire Wire;
@@ -0,0 +1,337 @@
+/******************************************************************************
+behavior.cpp
+RV-3028-C7 Arduino Library - host test
+
+Checks results, not bus transactions: the simulated clock is set to a known time
+(also after 20:00, where bit 5 of the hours register is a tens digit and not PM)
+and the values returned by the library are compared with the expected ones.
+Covers the sleep planner, the telemetry, the pulse counter, the EEPROM functions, the images and the weekday formula.
+
+This code is released under the [MIT License](http://opensource.org/licenses/MIT).
+Please review the LICENSE.md file included with this example.
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#include "RV-3028-C7.h"
+#include "RV-3028-C7_Sleep.h"
+
+static unsigned int checks;
+static unsigned int failed;
+
+static void check(bool ok, const char * what)
+{
+	checks++;
+	if (ok) return;
+	printf("FAIL %s\n", what);
+	failed++;
+}
+
+static uint8_t toBCD(uint8_t value)
+{
+	return (value / 10) << 4 | (value % 10);
+}
+
+static uint8_t fromBCD(uint8_t value)
+{
+	return (value >> 4) * 10 + (value & 0x0F);
+}
+
+/*********************************
+Simulated clock, 24 hour mode. Real time and UNIX Time are independent counters in the RTC,
+both are set and advanced here without the library.
+*********************************/
+static void setClock(uint16_t year, uint8_t month, uint8_t date, uint8_t hours, uint8_t minutes, uint8_t seconds, uint32_t unixTime)
+{
+	Wire.regs[RV3028_SECONDS] = toBCD(seconds);
+	Wire.regs[RV3028_MINUTES] = toBCD(minutes);
+	Wire.regs[RV3028_HOURS] = toBCD(hours);
+	Wire.regs[RV3028_DATE] = toBCD(date);
+	Wire.regs[RV3028_MONTHS] = toBCD(month);
+	Wire.regs[RV3028_YEARS] = toBCD(year - 2000);
+	for (uint8_t i = 0; i < 4; i++)
+		Wire.regs[RV3028_UNIX_TIME0 + i] = unixTime >> (8 * i);
+}
+
+static uint32_t clockUNIX()
+{
+	return ((uint32_t)Wire.regs[RV3028_UNIX_TIME3] << 24) | ((uint32_t)Wire.regs[RV3028_UNIX_TIME2] << 16)
+		| ((uint32_t)Wire.regs[RV3028_UNIX_TIME1] << 8) | Wire.regs[RV3028_UNIX_TIME0];
+}
+
+static void advanceClock(uint32_t seconds)
+{
+	RV3028_DateTime now;
+	now.seconds = fromBCD(Wire.regs[RV3028_SECONDS]);
+	now.minutes = fromBCD(Wire.regs[RV3028_MINUTES]);
+	now.hours = fromBCD(Wire.regs[RV3028_HOURS]);
+	now.date = fromBCD(Wire.regs[RV3028_DATE]);
+	now.month = fromBCD(Wire.regs[RV3028_MONTHS]);
+	now.year = fromBCD(Wire.regs[RV3028_YEARS]) + 2000;
+	RV3028_DateTime next = RV3028::UNIXtoDateTime(RV3028::dateTimeToUNIX(now) + seconds);
+	setClock(next.year, next.month, next.date, next.hours, next.minutes, next.seconds, clockUNIX() + seconds);
+}
+
+/*********************************
+Sleep hook of the planner: runs the countdown timer or the date alarm of the simulated RTC
+until it fires and sets its flag, like the INT pin would end the sleep of the MCU.
+*********************************/
+static unsigned int wakeUps;
+
+static bool alarmMatches()
+{
+	const uint8_t * alarm = &Wire.regs[RV3028_MINUTES_ALM];
+	if (!(alarm[0] & 1 << MINUTESALM_AE_M) && alarm[0] != Wire.regs[RV3028_MINUTES]) return false;
+	if (!(alarm[1] & 1 << HOURSALM_AE_H) && alarm[1] != Wire.regs[RV3028_HOURS]) return false;
+	if (!(alarm[2] & 1 << DATE_AE_WD) && alarm[2] != Wire.regs[RV3028_DATE]) return false;
+	return true;
+}
+
+static void simulatedSleep(void * context)
+{
+	(void)context;
+	wakeUps++;
+	uint8_t ctrl1 = Wire.regs[RV3028_CTRL1];
+	uint8_t ctrl2 = Wire.regs[RV3028_CTRL2];
+
+	if ((ctrl1 & 1 << CTRL1_TE) && (ctrl2 & 1 << CTRL2_TIE))
+	{
+		uint16_t value = Wire.regs[RV3028_TIMERVAL_0] | (Wire.regs[RV3028_TIMERVAL_1] & 0x0F) << 8;
+		uint8_t td = ctrl1 & (1 << CTRL1_TD1 | 1 << CTRL1_TD0);
+		check(td == TIMER_TD_1HZ || td == TIMER_TD_1_60HZ, "sleep: timer clock is 1Hz or 1/60Hz");
+		advanceClock(td == TIMER_TD_1HZ ? value : value * 60UL);
+		Wire.regs[RV3028_STATUS] |= 1 << STATUS_TF;
+		if (!(ctrl1 & 1 << CTRL1_TRPT)) Wire.regs[RV3028_CTRL1] &= ~(1 << CTRL1_TE); //Single mode stops
+	}
+	else if (ctrl2 & 1 << CTRL2_AIE)
+	{
+		check(ctrl1 & 1 << CTRL1_WADA, "sleep: alarm on the date");
+		advanceClock(60 - fromBCD(Wire.regs[RV3028_SECONDS])); //The alarm is checked when the minute changes
+		for (uint32_t minute = 0; alarmMatches() == false; minute++)
+		{
+			if (minute > 62 * 1440UL)
+			{
+				check(false, "sleep: alarm fires within two months");
+				return;
+			}
+			advanceClock(60);
+		}
+		Wire.regs[RV3028_STATUS] |= 1 << STATUS_AF;
+	}
+	else
+		check(false, "sleep: timer or alarm armed");
+}
+
+//Timer and alarm of the application that the planner has to restore
+static void applicationTimerAndAlarm(RV3028 &rtc)
+{
+	RV3028_Alarm alarm = { 30, 14, 5, false, 0, true };
+	rtc.setAlarm(alarm);
+	rtc.enableAlarmInterrupt();
+	Wire.regs[RV3028_TIMERVAL_0] = 0x23;
+	Wire.regs[RV3028_TIMERVAL_1] = 0x01;
+	Wire.regs[RV3028_CTRL1] |= 1 << CTRL1_TRPT | TIMER_TD_1HZ; //Repeat mode, not started
+}
+
+static bool restored(const uint8_t * before)
+{
+	const uint8_t ctrl1Bits = 1 << CTRL1_TRPT | 1 << CTRL1_WADA | 1 << CTRL1_TE | 1 << CTRL1_TD1 | 1 << CTRL1_TD0;
+	const uint8_t ctrl2Bits = 1 << CTRL2_TIE | 1 << CTRL2_AIE;
+	return memcmp(before, &Wire.regs[RV3028_MINUTES_ALM], RV3028_TIMERVAL_1 - RV3028_MINUTES_ALM + 1) == 0
+		&& (before[RV3028_CTRL1 - RV3028_MINUTES_ALM] & ctrl1Bits) == (Wire.regs[RV3028_CTRL1] & ctrl1Bits)
+		&& (before[RV3028_CTRL2 - RV3028_MINUTES_ALM] & ctrl2Bits) == (Wire.regs[RV3028_CTRL2] & ctrl2Bits);
+}
+
+//Sleeps for seconds from 2026-10-19 21:37:27 and checks the wake ups and the restored application settings
+static void sleepFor(const char * name, uint32_t seconds, unsigned int expectedWakeUps, uint8_t expectedCause)
+{
+	Wire.powerOn();
+	RV3028 rtc;
+	rtc.begin();
+	setClock(2026, 10, 19, 21, 37, 27, 1700000000);
+	applicationTimerAndAlarm(rtc);
+	uint8_t before[RV3028_CTRL2 - RV3028_MINUTES_ALM + 1];
+	memcpy(before, &Wire.regs[RV3028_MINUTES_ALM], sizeof(before));
+
+	RV3028_Sleep planner(rtc);
+	planner.setSleepHook(simulatedSleep);
+	wakeUps = 0;
+	uint8_t cause = planner.sleepFor(seconds);
+
+	char what[80];
+	snprintf(what, sizeof(what), "%s: target reached", name);
+	check(clockUNIX() == 1700000000 + seconds, what);
+	snprintf(what, sizeof(what), "%s: %u wake ups", name, expectedWakeUps);
+	check(wakeUps == expectedWakeUps, what);
+	snprintf(what, sizeof(what), "%s: wake cause", name);
+	check(cause == expectedCause, what);
+	snprintf(what, sizeof(what), "%s: timer and alarm of the application restored", name);
+	check(restored(before), what);
+}
+
+static void sleepChecks()
+{
+	sleepFor("sleepFor(30)", 30, 1, SLEEP_WAKE_TIMER);
+	sleepFor("sleepFor(5000) 1/60Hz timer + 1Hz rest", 5000, 2, SLEEP_WAKE_TIMER);
+	sleepFor("sleepFor(7 days) alarm + 1Hz rest", 7 * 86400UL, 2, SLEEP_WAKE_TIMER);
+	sleepFor("sleepFor(40 days) two alarms + 1Hz rest", 40 * 86400UL, 3, SLEEP_WAKE_TIMER);
+
+	//arm() alone has to program the wake time, not rely on a later re-arm
+	Wire.powerOn();
+	RV3028 rtc;
+	rtc.begin();
+	setClock(2026, 10, 19, 21, 37, 27, 1700000000);
+	RV3028_Sleep planner(rtc);
+	planner.arm(40 * 86400UL);
+	check(Wire.regs[RV3028_MINUTES_ALM] == 0x37 && Wire.regs[RV3028_HOURS_ALM] == 0x21 && Wire.regs[RV3028_DATE_ALM] == 0x15,
+		"arm(40 days) at 21:37: alarm on the 15th at 21:37");
+	planner.disarm();
+}
+
+/*********************************
+Telemetry: calendar offset at 08:53 and 21:37 with real time and UNIX Time in agreement,
+correction of resync() and drift of a UNIX Time that gained 3 seconds in 2 days.
+*********************************/
+static void telemetryChecks()
+{
+	Wire.powerOn();
+	RV3028 rtc;
+	rtc.begin();
+
+	setClock(2026, 10, 19, 8, 53, 0, 1792399980);
+	rtc.updateTelemetry(1792399980);
+	check(rtc.getTelemetry().calendarOffset == 0, "updateTelemetry() at 08:53: calendarOffset 0");
+
+	setClock(2026, 10, 19, 21, 37, 27, 1792445847);
+	rtc.updateTelemetry(1792445847);
+	check(rtc.getTelemetry().calendarOffset == 0, "updateTelemetry() at 21:37: calendarOffset 0");
+
+	rtc.resync(1792445847 + 5);
+	check(rtc.getTelemetry().lastCorrection == 5, "resync() 5 seconds late: lastCorrection 5");
+	check(clockUNIX() == 1792445847 + 5, "resync(): UNIX Time set");
+
+	//Real time gains 2 seconds in 2 days, the UNIX Time one more
+	advanceClock(2 * 86400UL + 2);
+	Wire.regs[RV3028_UNIX_TIME0]++;
+	rtc.updateTelemetry(1792445847 + 5 + 2 * 86400UL);
+	RV3028_Telemetry telemetry = rtc.getTelemetry();
+	check(telemetry.driftSamples == 1, "updateTelemetry() after 2 days: one drift sample");
+	check(telemetry.driftLast == 173, "updateTelemetry() after 2 days: driftLast 17.3 ppm");
+	check(telemetry.driftMin == 173 && telemetry.driftMax == 173, "updateTelemetry() after 2 days: driftMin and driftMax");
+	check(telemetry.calendarOffset == -1, "updateTelemetry() after 2 days: calendarOffset -1");
+}
+
+//Pulse counter: rate of two readings with pulses, then readings without pulses while the meter stands still
+static void pulseTimeStamp(uint8_t count, uint8_t minutes, uint8_t seconds)
+{
+	const uint8_t timeStamp[] = { toBCD(seconds), toBCD(minutes), 0x21, 0x19, 0x10, 0x26 }; //2026-10-19 21:mm:ss
+	memcpy(&Wire.regs[RV3028_SECONDS_TS], timeStamp, sizeof(timeStamp));
+	Wire.regs[RV3028_COUNT_TS] = count;
+}
+
+static void pulseCounterChecks()
+{
+	Wire.powerOn();
+	RV3028 rtc;
+	rtc.begin();
+	rtc.enablePulseCounter();
+
+	pulseTimeStamp(10, 0, 0);
+	setClock(2026, 10, 19, 21, 0, 1, 1792443601);
+	rtc.updatePulseCounter();
+	check(rtc.getPulseCount() == 10 && rtc.getPulseRate() == 0, "updatePulseCounter() first reading: 10 pulses, no rate");
+	check(rtc.getPulseTime() == 1792443600, "updatePulseCounter() first reading: time of the last pulse 21:00:00");
+
+	pulseTimeStamp(20, 0, 10);
+	setClock(2026, 10, 19, 21, 0, 11, 1792443611);
+	rtc.updatePulseCounter();
+	check(rtc.getPulseCount() == 20 && rtc.getPulseRate() == 1.0, "updatePulseCounter() 10 pulses in 10 s: rate 1");
+
+	setClock(2026, 10, 19, 21, 0, 11, 1792443611);
+	rtc.updatePulseCounter();
+	check(rtc.getPulseRate() == 1.0, "updatePulseCounter() no pulse for 1 s: rate 1");
+
+	setClock(2026, 10, 19, 21, 1, 50, 1792443710);
+	rtc.updatePulseCounter();
+	check(rtc.getPulseCount() == 20 && rtc.getPulseRate() == 0.01f, "updatePulseCounter() no pulse for 100 s: rate 0.01");
+}
+
+//Waiting for the EEPROM must not clear interrupt flags before the dispatcher sees them
+static void eepromFlagChecks()
+{
+	Wire.powerOn();
+	RV3028 rtc;
+	rtc.begin();
+	RV3028_Image image;
+	const uint8_t flags = 1 << STATUS_AF | 1 << STATUS_TF | 1 << STATUS_EVF | 1 << STATUS_BSF;
+	Wire.regs[RV3028_STATUS] |= flags;
+
+	rtc.enableTrickleCharge(TCR_3K);
+	rtc.setBackupSwitchoverMode(1);
+	rtc.writeConfigEEPROM_RAMmirror(EEPROM_Clkout_Register, 0xC0);
+	rtc.readConfigEEPROM_RAMmirror(EEPROM_Clkout_Register);
+	rtc.dumpImage(image);
+	rtc.restoreImage(image);
+	rtc.beginWriteBatch();
+	rtc.disableTrickleCharge();
+	rtc.endWriteBatch();
+	check((Wire.regs[RV3028_STATUS] & flags) == flags, "EEPROM functions: AF, TF, EVF and BSF still set");
+}
+
+//Restore of an image that differs in configuration EEPROM, registers and user EEPROM
+static void imageChecks()
+{
+	Wire.powerOn();
+	RV3028 rtc;
+	rtc.begin();
+	RV3028_Image image;
+	rtc.dumpImage(image);
+	image.configEEPROM[EEPROM_Clkout_Register - EEPROM_Config_First] = 0xC0;
+	image.configEEPROM[EEPROM_Backup_Register - EEPROM_Config_First] ^= 1 << EEPROMBackup_TCE_BIT;
+	image.registers[RV3028_MINUTES_ALM] = 0x30;
+	image.registers[RV3028_USER_RAM1] = 0x55;
+	image.userEEPROM[0] = 0xA5;
+	image.userEEPROM[IMAGE_USER_EEPROM_LENGTH - 1] = 0x5A;
+	image.crc = RV3028::imageCRC(image);
+
+	unsigned long updates = Wire.eepromUpdates;
+	check(rtc.restoreImage(image), "restoreImage() changed image: success");
+	check(Wire.eepromUpdates - updates == 1, "restoreImage() changed image: exactly one EEPROM Update");
+	check(memcmp(&Wire.eeprom[EEPROM_Config_First], image.configEEPROM, IMAGE_CONFIG_LENGTH) == 0, "restoreImage() changed image: configuration EEPROM");
+	check(Wire.regs[RV3028_MINUTES_ALM] == 0x30 && Wire.regs[RV3028_USER_RAM1] == 0x55, "restoreImage() changed image: registers");
+	check(Wire.eeprom[EEPROM_User_First] == 0xA5 && Wire.eeprom[EEPROM_User_Last] == 0x5A, "restoreImage() changed image: user EEPROM");
+
+	RV3028_Image restored;
+	rtc.dumpImage(restored);
+	updates = Wire.eepromUpdates;
+	rtc.restoreImage(restored);
+	check(Wire.eepromUpdates == updates, "restoreImage() unchanged image: no EEPROM Update");
+}
+
+//Weekday formula of setToCompilerTime() against the day count of UNIXtoDateTime()
+static void weekdayChecks()
+{
+	check(RV3028::weekdayFromDate(2026, 10, 19) == 1, "weekdayFromDate() 2026-10-19 is a Monday");
+	check(RV3028::weekdayFromDate(2000, 1, 1) == 6, "weekdayFromDate() 2000-01-01 is a Saturday");
+	check(RV3028::weekdayFromDate(2024, 2, 29) == 4, "weekdayFromDate() 2024-02-29 is a Thursday");
+
+	bool same = true;
+	for (uint32_t day = 0; day < 100 * 366UL; day++)
+	{
+		RV3028_DateTime dateTime = RV3028::UNIXtoDateTime(946684800 + day * 86400); //From 2000-01-01
+		if (RV3028::weekdayFromDate(dateTime.year, dateTime.month, dateTime.date) != dateTime.weekday) same = false;
+	}
+	check(same, "weekdayFromDate() equals the weekday of UNIXtoDateTime() for 100 years");
+}
+
+int main()
+{
+	sleepChecks();
+	telemetryChecks();
+	pulseCounterChecks();
+	eepromFlagChecks();
+	imageChecks();
+	weekdayChecks();
+
+	printf("%u of %u behavior checks passed\n", checks - failed, checks);
+	return failed == 0 ? 0 : 1;
+}
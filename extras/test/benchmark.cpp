@@ -0,0 +1,89 @@
+/******************************************************************************
+benchmark.cpp
+RV-3028-C7 Arduino Library - host test
+
+Times the functions that run without bus access: conversions, string functions,
+the weekday formula of setToCompilerTime() and the 12/24 hour conversion of the getters.
+Only for comparing library versions on the same PC, nothing is asserted.
+
+This code is released under the [MIT License](http://opensource.org/licenses/MIT).
+Please review the LICENSE.md file included with this example.
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#include "RV-3028-C7.h"
+
+#define RUNS 1000000UL
+
+//Keeps the compiler from optimizing the measured calls away
+static volatile uint8_t sink;
+
+static void printResult(const char * name, unsigned long start)
+{
+	printf("%-28s %8.1f ns\n", name, (micros() - start) * 1000.0 / RUNS);
+}
+
+int main()
+{
+	RV3028 rtc;
+	rtc.begin();
+	rtc.setTime(59, 59, 23, 6, 31, 12, 2026);
+	rtc.updateTime();
+	unsigned long start;
+
+	start = micros();
+	for (unsigned long i = 0; i < RUNS; i++)
+		sink = rtc.BCDtoDEC(i % 0x9A);
+	printResult("BCDtoDEC()", start);
+
+	start = micros();
+	for (unsigned long i = 0; i < RUNS; i++)
+		sink = rtc.DECtoBCD(i % 100);
+	printResult("DECtoBCD()", start);
+
+	start = micros();
+	for (unsigned long i = 0; i < RUNS; i++)
+		sink = RV3028::weekdayFromDate(2000 + i % 100, 1 + i % 12, 1 + i % 28);
+	printResult("weekdayFromDate()", start);
+
+	char buffer[STRING_TIMESTAMP_LENGTH];
+	for (uint8_t mode = 0; mode < 2; mode++)
+	{
+		//Software hour mode keeps the 12/24 hour conversion off the bus
+		rtc.enableSoftwareHourMode();
+		if (mode == 0) rtc.set24Hour();
+		else rtc.set12Hour();
+		printf("%s\n", mode == 0 ? "24 hour format" : "12 hour format");
+
+		start = micros();
+		for (unsigned long i = 0; i < RUNS; i++)
+			sink = rtc.stringDateUSA(buffer)[0];
+		printResult("stringDateUSA(buffer)", start);
+
+		start = micros();
+		for (unsigned long i = 0; i < RUNS; i++)
+			sink = rtc.stringDate(buffer)[0];
+		printResult("stringDate(buffer)", start);
+
+		start = micros();
+		for (unsigned long i = 0; i < RUNS; i++)
+			sink = rtc.stringTime(buffer)[0];
+		printResult("stringTime(buffer)", start);
+
+		start = micros();
+		for (unsigned long i = 0; i < RUNS; i++)
+			sink = rtc.stringTimeStamp(buffer)[0];
+		printResult("stringTimeStamp(buffer)", start);
+
+		start = micros();
+		for (unsigned long i = 0; i < RUNS; i++)
+			sink = rtc.getHours();
+		printResult("getHours()", start);
+
+		start = micros();
+		for (unsigned long i = 0; i < RUNS; i++)
+			sink = rtc.getDateTime().hours;
+		printResult("getDateTime()", start);
+	}
+	return 0;
+}
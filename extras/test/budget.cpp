@@ -0,0 +1,220 @@
+/******************************************************************************
+budget.cpp
+RV-3028-C7 Arduino Library - host test
+
+Bus transaction budget of every public function: each function runs on a freshly started
+simulated RTC and the number of bus transactions (endTransmission() and requestFrom())
+has to match the table exactly. An extra register read fails the test, a saved one
+has to be recorded by lowering the budget.
+
+This code is released under the [MIT License](http://opensource.org/licenses/MIT).
+Please review the LICENSE.md file included with this example.
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#include "RV-3028-C7.h"
+#include "RV-3028-C7_Dispatcher.h"
+#include "RV-3028-C7_Sleep.h"
+#include "RV-3028-C7_TimeZone.h"
+
+struct Budget
+{
+	const char * name;
+	unsigned long transactions;
+	void (*prepare)(RV3028 &rtc); //State before the measurement, NULL if none
+	void (*run)(RV3028 &rtc);
+};
+
+static RV3028_Image image;
+static RV3028_Alarm alarm = { 30, 14, 5, false, 0, true };
+static uint8_t buffer[RV3028_BURST_LENGTH * 2];
+static char text[STRING_TIMESTAMP_LENGTH];
+
+static void twelveHour(RV3028 &rtc) { rtc.set12Hour(); }
+static void softwareHourMode(RV3028 &rtc) { rtc.enableSoftwareHourMode(); }
+static void alarmSet(RV3028 &rtc) { rtc.setAlarm(alarm); }
+static void pulseCounter(RV3028 &rtc) { rtc.enablePulseCounter(); }
+static void synced(RV3028 &rtc) { rtc.resync(1700000000); }
+static void dumped(RV3028 &rtc) { rtc.dumpImage(image); }
+static void alarmFlag(RV3028 &rtc) { (void)rtc; Wire.regs[RV3028_STATUS] |= 1 << STATUS_AF; }
+static void noLock(void * context) { (void)context; }
+static void locked(RV3028 &rtc) { rtc.setLock(noLock, noLock); }
+static void noHandler(uint8_t source) { (void)source; }
+static void timerFired(void * context) { (void)context; Wire.regs[RV3028_STATUS] |= 1 << STATUS_TF; Wire.regs[RV3028_UNIX_TIME0] += 30; }
+
+//Image that differs from the unit in configuration EEPROM, registers and user EEPROM
+static void changedImage(RV3028 &rtc)
+{
+	rtc.dumpImage(image);
+	image.configEEPROM[EEPROM_Clkout_Register - EEPROM_Config_First] = 0xC0;
+	image.configEEPROM[EEPROM_Backup_Register - EEPROM_Config_First] ^= 1 << EEPROMBackup_TCE_BIT;
+	image.registers[RV3028_MINUTES_ALM] = 0x30;
+	image.registers[RV3028_USER_RAM1] = 0x55;
+	image.userEEPROM[0] = 0xA5;
+	image.userEEPROM[IMAGE_USER_EEPROM_LENGTH - 1] = 0x5A;
+	image.crc = RV3028::imageCRC(image);
+}
+
+static const Budget budgets[] =
+{
+	{ "begin()", 35, NULL, [](RV3028 &rtc) { rtc.begin(); } },
+	{ "begin(Wire, true) warm", 2, [](RV3028 &rtc) { rtc.begin(Wire, true); }, [](RV3028 &rtc) { rtc.begin(Wire, true); } },
+	{ "bootStatus()", 0, NULL, [](RV3028 &rtc) { rtc.bootStatus(); } },
+	{ "setTime(sec, ...)", 3, NULL, [](RV3028 &rtc) { rtc.setTime(0, 30, 14, 4, 19, 10, 2026); } },
+	{ "setTime(sec, ...) 12 hour", 19, twelveHour, [](RV3028 &rtc) { rtc.setTime(0, 30, 14, 4, 19, 10, 2026); } },
+	{ "setTime(array)", 1, NULL, [](RV3028 &rtc) { uint8_t time[TIME_ARRAY_LENGTH] = { 0 }; rtc.setTime(time, TIME_ARRAY_LENGTH); } },
+	{ "setSeconds()", 1, NULL, [](RV3028 &rtc) { rtc.setSeconds(10); } },
+	{ "setMinutes()", 1, NULL, [](RV3028 &rtc) { rtc.setMinutes(10); } },
+	{ "setHours()", 1, NULL, [](RV3028 &rtc) { rtc.setHours(10); } },
+	{ "setWeekday()", 1, NULL, [](RV3028 &rtc) { rtc.setWeekday(3); } },
+	{ "setDate()", 1, NULL, [](RV3028 &rtc) { rtc.setDate(10); } },
+	{ "setMonth()", 1, NULL, [](RV3028 &rtc) { rtc.setMonth(10); } },
+	{ "setYear()", 1, NULL, [](RV3028 &rtc) { rtc.setYear(2026); } },
+	{ "setToCompilerTime()", 3, NULL, [](RV3028 &rtc) { rtc.setToCompilerTime(); } },
+	{ "updateTime()", 4, NULL, [](RV3028 &rtc) { rtc.updateTime(); } },
+	{ "updateTime() 12 hour", 4, twelveHour, [](RV3028 &rtc) { rtc.updateTime(); } },
+	{ "stringDateUSA()", 0, NULL, [](RV3028 &rtc) { rtc.stringDateUSA(); } },
+	{ "stringDate()", 0, NULL, [](RV3028 &rtc) { rtc.stringDate(); } },
+	{ "stringDateUSA(buffer)", 0, NULL, [](RV3028 &rtc) { rtc.stringDateUSA(text); } },
+	{ "stringDate(buffer)", 0, NULL, [](RV3028 &rtc) { rtc.stringDate(text); } },
+	{ "stringTime()", 0, NULL, [](RV3028 &rtc) { rtc.stringTime(); } },
+	{ "stringTime(buffer)", 0, NULL, [](RV3028 &rtc) { rtc.stringTime(text); } },
+	{ "stringTimeStamp()", 0, NULL, [](RV3028 &rtc) { rtc.stringTimeStamp(); } },
+	{ "stringTimeStamp(buffer)", 0, NULL, [](RV3028 &rtc) { rtc.stringTimeStamp(text); } },
+	{ "getDateTime()", 0, NULL, [](RV3028 &rtc) { rtc.getDateTime(); } },
+	{ "getSeconds()", 0, NULL, [](RV3028 &rtc) { rtc.getSeconds(); } },
+	{ "getMinutes()", 0, NULL, [](RV3028 &rtc) { rtc.getMinutes(); } },
+	{ "getHours()", 0, NULL, [](RV3028 &rtc) { rtc.getHours(); } },
+	{ "getWeekday()", 0, NULL, [](RV3028 &rtc) { rtc.getWeekday(); } },
+	{ "getDate()", 0, NULL, [](RV3028 &rtc) { rtc.getDate(); } },
+	{ "getMonth()", 0, NULL, [](RV3028 &rtc) { rtc.getMonth(); } },
+	{ "getYear()", 0, NULL, [](RV3028 &rtc) { rtc.getYear(); } },
+	{ "is12Hour()", 2, NULL, [](RV3028 &rtc) { rtc.is12Hour(); } },
+	{ "is12Hour() software", 0, softwareHourMode, [](RV3028 &rtc) { rtc.is12Hour(); } },
+	{ "isPM()", 0, NULL, [](RV3028 &rtc) { rtc.isPM(); } },
+	{ "set12Hour()", 8, NULL, [](RV3028 &rtc) { rtc.set12Hour(); } },
+	{ "set24Hour()", 8, twelveHour, [](RV3028 &rtc) { rtc.set24Hour(); } },
+	{ "set24Hour() unchanged", 2, NULL, [](RV3028 &rtc) { rtc.set24Hour(); } },
+	{ "enableSoftwareHourMode()", 2, NULL, [](RV3028 &rtc) { rtc.enableSoftwareHourMode(); } },
+	{ "disableSoftwareHourMode()", 0, softwareHourMode, [](RV3028 &rtc) { rtc.disableSoftwareHourMode(); } },
+	{ "setUNIX()", 1, NULL, [](RV3028 &rtc) { rtc.setUNIX(1700000000); } },
+	{ "getUNIX()", 2, NULL, [](RV3028 &rtc) { rtc.getUNIX(); } },
+	{ "enableAlarmInterrupt(...)", 15, NULL, [](RV3028 &rtc) { rtc.enableAlarmInterrupt(30, 14, 5, false, 0); } },
+	{ "enableAlarmInterrupt()", 3, NULL, [](RV3028 &rtc) { rtc.enableAlarmInterrupt(); } },
+	{ "disableAlarmInterrupt()", 3, NULL, [](RV3028 &rtc) { rtc.disableAlarmInterrupt(); } },
+	{ "readAlarmInterruptFlag()", 3, alarmFlag, [](RV3028 &rtc) { rtc.readAlarmInterruptFlag(); } },
+	{ "setAlarm()", 3, NULL, [](RV3028 &rtc) { rtc.setAlarm(alarm); } },
+	{ "setAlarm() unchanged", 2, alarmSet, [](RV3028 &rtc) { rtc.setAlarm(alarm); } },
+	{ "getAlarm()", 2, NULL, [](RV3028 &rtc) { RV3028_Alarm current; rtc.getAlarm(current); } },
+	{ "enablePulseCounter()", 3, NULL, [](RV3028 &rtc) { rtc.enablePulseCounter(); } },
+	{ "disablePulseCounter()", 3, pulseCounter, [](RV3028 &rtc) { rtc.disablePulseCounter(); } },
+	{ "resetPulseCounter()", 3, pulseCounter, [](RV3028 &rtc) { rtc.resetPulseCounter(); } },
+	{ "updatePulseCounter()", 2, pulseCounter, [](RV3028 &rtc) { rtc.updatePulseCounter(); } },
+	{ "getPulseCount()", 0, NULL, [](RV3028 &rtc) { rtc.getPulseCount(); } },
+	{ "getPulseTime()", 0, NULL, [](RV3028 &rtc) { rtc.getPulseTime(); } },
+	{ "getPulseRate()", 0, NULL, [](RV3028 &rtc) { rtc.getPulseRate(); } },
+	{ "updateTelemetry()", 2, synced, [](RV3028 &rtc) { rtc.updateTelemetry(1700100000); } },
+	{ "resync()", 6, NULL, [](RV3028 &rtc) { rtc.resync(1700000000); } },
+	{ "getTelemetry()", 0, NULL, [](RV3028 &rtc) { rtc.getTelemetry(); } },
+	{ "resetTelemetry()", 0, NULL, [](RV3028 &rtc) { rtc.resetTelemetry(); } },
+	{ "setLock()", 0, NULL, [](RV3028 &rtc) { rtc.setLock(noLock, noLock); } },
+	{ "lock() + unlock()", 0, locked, [](RV3028 &rtc) { rtc.lock(); rtc.unlock(); } },
+	{ "updateTime() with lock", 4, locked, [](RV3028 &rtc) { rtc.updateTime(); } },
+	{ "enableTrickleCharge()", 32, NULL, [](RV3028 &rtc) { rtc.enableTrickleCharge(TCR_3K); } },
+	{ "disableTrickleCharge()", 32, NULL, [](RV3028 &rtc) { rtc.disableTrickleCharge(); } },
+	{ "setBackupSwitchoverMode()", 32, NULL, [](RV3028 &rtc) { rtc.setBackupSwitchoverMode(1); } },
+	{ "status()", 3, NULL, [](RV3028 &rtc) { rtc.status(); } },
+	{ "clearInterrupts()", 3, NULL, [](RV3028 &rtc) { rtc.clearInterrupts(); } },
+	{ "BCDtoDEC()", 0, NULL, [](RV3028 &rtc) { rtc.BCDtoDEC(0x59); } },
+	{ "DECtoBCD()", 0, NULL, [](RV3028 &rtc) { rtc.DECtoBCD(59); } },
+	{ "readRegister()", 2, NULL, [](RV3028 &rtc) { rtc.readRegister(RV3028_CTRL1); } },
+	{ "writeRegister()", 1, NULL, [](RV3028 &rtc) { rtc.writeRegister(RV3028_USER_RAM1, 0x55); } },
+	{ "readMultipleRegisters()", 2, NULL, [](RV3028 &rtc) { rtc.readMultipleRegisters(RV3028_SECONDS, buffer, RV3028_BURST_LENGTH); } },
+	{ "readMultipleRegisters() 2 bursts", 4, NULL, [](RV3028 &rtc) { rtc.readMultipleRegisters(RV3028_SECONDS, buffer, RV3028_BURST_LENGTH + 1); } },
+	{ "writeMultipleRegisters()", 1, NULL, [](RV3028 &rtc) { rtc.writeMultipleRegisters(RV3028_USER_RAM1, buffer, 2); } },
+	{ "writeConfigEEPROM_RAMmirror()", 15, NULL, [](RV3028 &rtc) { rtc.writeConfigEEPROM_RAMmirror(EEPROM_Clkout_Register, 0xC0); } },
+	{ "readConfigEEPROM_RAMmirror()", 17, NULL, [](RV3028 &rtc) { rtc.readConfigEEPROM_RAMmirror(EEPROM_Clkout_Register); } },
+	{ "waitforEEPROM()", 2, NULL, [](RV3028 &rtc) { rtc.waitforEEPROM(); } },
+	{ "beginWriteBatch() + endWriteBatch()", 0, NULL, [](RV3028 &rtc) { rtc.beginWriteBatch(); rtc.endWriteBatch(); } },
+	{ "write batch of 3 adjacent registers", 1, NULL, [](RV3028 &rtc) {
+		rtc.beginWriteBatch();
+		rtc.writeRegister(RV3028_MINUTES_ALM, 0x30);
+		rtc.writeRegister(RV3028_HOURS_ALM, 0x14);
+		rtc.writeRegister(RV3028_DATE_ALM, 0x05);
+		rtc.endWriteBatch(); } },
+	{ "write batch restarting the timer", 5, NULL, [](RV3028 &rtc) {
+		rtc.beginWriteBatch();
+		uint8_t ctrl1 = rtc.readRegister(RV3028_CTRL1);
+		rtc.writeRegister(RV3028_CTRL1, ctrl1 & ~(1 << CTRL1_TE));
+		rtc.writeRegister(RV3028_TIMERVAL_0, 0x34);
+		rtc.writeRegister(RV3028_TIMERVAL_1, 0x02);
+		rtc.writeRegister(RV3028_CTRL1, ctrl1 | 1 << CTRL1_TE);
+		rtc.endWriteBatch(); } },
+	{ "write batch of 2 configuration registers", 30, NULL, [](RV3028 &rtc) {
+		rtc.beginWriteBatch();
+		rtc.enableTrickleCharge(TCR_3K);
+		rtc.setBackupSwitchoverMode(1);
+		rtc.endWriteBatch(); } },
+	{ "dumpImage()", 270, NULL, [](RV3028 &rtc) { rtc.dumpImage(image); } },
+	{ "restoreImage() unchanged", 270, dumped, [](RV3028 &rtc) { rtc.restoreImage(image); } },
+	{ "restoreImage() changed", 286, changedImage, [](RV3028 &rtc) { rtc.restoreImage(image); } },
+	{ "imageCRC()", 0, dumped, [](RV3028 &rtc) { (void)rtc; RV3028::imageCRC(image); } },
+	{ "dateTimeToUNIX() + UNIXtoDateTime()", 0, NULL, [](RV3028 &rtc) { (void)rtc; RV3028::dateTimeToUNIX(RV3028::UNIXtoDateTime(1700000000)); } },
+	{ "daysFromDate()", 0, NULL, [](RV3028 &rtc) { (void)rtc; RV3028::daysFromDate(2026, 10, 19); } },
+	{ "weekdayFromDate()", 0, NULL, [](RV3028 &rtc) { (void)rtc; RV3028::weekdayFromDate(2026, 10, 19); } },
+	{ "RV3028_TimeZone.toLocal(rtc)", 0, NULL, [](RV3028 &rtc) { RV3028_TimeZone tz; tz.begin("CET-1CEST,M3.5.0,M10.5.0/3", 2026, 1); tz.toLocal(rtc); } },
+	{ "RV3028_TimeZone.offset() + isDST() + toLocal()", 0, NULL, [](RV3028 &rtc) { (void)rtc; RV3028_TimeZone tz; tz.begin("CET-1CEST,M3.5.0,M10.5.0/3", 2026, 1);
+		tz.offset(1792445847); tz.isDST(1792445847); tz.toLocal(1792445847); } },
+	{ "RV3028_Dispatcher.service()", 5, alarmFlag, [](RV3028 &rtc) { RV3028_Dispatcher dispatcher(rtc); dispatcher.service(); } },
+	{ "RV3028_Dispatcher.service() twice", 5, alarmFlag, [](RV3028 &rtc) { RV3028_Dispatcher dispatcher(rtc); dispatcher.service(); dispatcher.service(); } },
+	{ "RV3028_Dispatcher without service()", 0, NULL, [](RV3028 &rtc) {
+		RV3028_Dispatcher dispatcher(rtc);
+		RV3028_Event event;
+		dispatcher.attachHandler(STATUS_AF, noHandler);
+		dispatcher.detachHandler(STATUS_AF);
+		dispatcher.interrupt();
+		dispatcher.pending();
+		dispatcher.readEvent(event);
+		dispatcher.droppedEvents(); } },
+	{ "RV3028_Dispatcher.service() with handler and event", 5, alarmFlag, [](RV3028 &rtc) {
+		RV3028_Dispatcher dispatcher(rtc);
+		RV3028_Event event;
+		dispatcher.attachHandler(STATUS_AF, noHandler);
+		dispatcher.interrupt();
+		dispatcher.service();
+		dispatcher.readEvent(event); } },
+	{ "RV3028_Sleep.arm() timer", 3, NULL, [](RV3028 &rtc) { RV3028_Sleep planner(rtc); planner.arm(60); } },
+	{ "RV3028_Sleep.arm() alarm", 5, NULL, [](RV3028 &rtc) { RV3028_Sleep planner(rtc); planner.arm(7 * 86400UL); } },
+	{ "RV3028_Sleep.arm() 40 days", 5, NULL, [](RV3028 &rtc) { RV3028_Sleep planner(rtc); planner.arm(40 * 86400UL); } },
+	{ "RV3028_Sleep.arm() + disarm() timer", 7, NULL, [](RV3028 &rtc) { RV3028_Sleep planner(rtc); planner.arm(60); planner.disarm(); } },
+	{ "RV3028_Sleep.disarm() not armed", 0, NULL, [](RV3028 &rtc) { RV3028_Sleep planner(rtc); planner.disarm(); } },
+	{ "RV3028_Sleep.sleepFor(30)", 14, NULL, [](RV3028 &rtc) { RV3028_Sleep planner(rtc); planner.setSleepHook(timerFired); planner.sleepFor(30); planner.source(); } },
+	{ "RV3028_Sleep.wakeCause()", 2, NULL, [](RV3028 &rtc) { RV3028_Sleep planner(rtc); planner.wakeCause(); } },
+};
+
+int main()
+{
+	unsigned int failed = 0;
+	unsigned int count = sizeof(budgets) / sizeof(budgets[0]);
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		Wire.powerOn();
+		RV3028 rtc;
+		rtc.begin();
+		if (budgets[i].prepare != NULL) budgets[i].prepare(rtc);
+
+		unsigned long start = Wire.transactions;
+		budgets[i].run(rtc);
+		unsigned long used = Wire.transactions - start;
+
+		if (used != budgets[i].transactions)
+		{
+			printf("FAIL %-45s budget %3lu, used %3lu\n", budgets[i].name, budgets[i].transactions, used);
+			failed++;
+		}
+	}
+
+	printf("%u of %u bus budgets met\n", count - failed, count);
+	return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+/******************************************************************************
+stress.cpp
+RV-3028-C7 Arduino Library - host test
+
+One RV3028 shared by several threads with a recursive pthread mutex as lock (see setLock()):
+a writer sets times whose fields are all equal, an updater publishes them with updateTime()
+and readers check that getDateTime() and the string functions never see a torn time.
+The window for a torn read is a few instructions, so run it on a PC with several cores.
+
+This code is released under the [MIT License](http://opensource.org/licenses/MIT).
+Please review the LICENSE.md file included with this example.
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#include "RV-3028-C7.h"
+#include <pthread.h>
+
+#define WRITES 100000
+
+static RV3028 rtc;
+static pthread_mutex_t mutex;
+static volatile bool stop = false;
+static volatile unsigned long reads = 0;
+static volatile unsigned long torn = 0;
+
+static void lock(void * context) { pthread_mutex_lock((pthread_mutex_t *)context); }
+static void unlock(void * context) { pthread_mutex_unlock((pthread_mutex_t *)context); }
+
+//Every field (and the year in 2000 + value) is value, 11 in the morning or 22 in the evening
+static void * writer(void *)
+{
+	for (unsigned long i = 0; i < WRITES; i++)
+	{
+		uint8_t value = i % 2 ? 11 : 22;
+		rtc.setTime(value, value, value, value % 7, value, value % 12, 2000 + value);
+	}
+	stop = true;
+	return NULL;
+}
+
+static void * updater(void *)
+{
+	while (!stop) rtc.updateTime();
+	return NULL;
+}
+
+static void * reader(void *)
+{
+	char buffer[STRING_TIMESTAMP_LENGTH];
+	while (!stop)
+	{
+		RV3028_DateTime dateTime = rtc.getDateTime();
+		if (dateTime.seconds != dateTime.minutes || dateTime.minutes != dateTime.hours
+			|| dateTime.year - 2000 != dateTime.seconds)
+			torn++;
+
+		//yy and ss of "20yy-mm-dd hh:mm:ss" come from the same snapshot
+		size_t length = strlen(rtc.stringTimeStamp(buffer));
+		if (buffer[2] != buffer[length - 2] || buffer[3] != buffer[length - 1])
+			torn++;
+		reads++;
+	}
+	return NULL;
+}
+
+int main()
+{
+	pthread_mutexattr_t attributes;
+	pthread_mutexattr_init(&attributes);
+	pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&mutex, &attributes);
+	rtc.setLock(lock, unlock, &mutex);
+
+	rtc.begin();
+	rtc.setTime(11, 11, 11, 4, 11, 11, 2011);
+	rtc.updateTime();
+
+	pthread_t threads[4];
+	pthread_create(&threads[0], NULL, writer, NULL);
+	pthread_create(&threads[1], NULL, updater, NULL);
+	pthread_create(&threads[2], NULL, reader, NULL);
+	pthread_create(&threads[3], NULL, reader, NULL);
+	for (uint8_t i = 0; i < 4; i++)
+		pthread_join(threads[i], NULL);
+
+	printf("%lu snapshot reads, %lu torn\n", reads, torn);
+	return torn == 0 && reads > 0 ? 0 : 1;
+}
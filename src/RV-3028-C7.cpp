@@ -64,45 +64,145 @@ BUILD_MONTH_OCT | BUILD_MONTH_NOV | BUILD_MONTH_DEC
 #define BUILD_SECOND_1 (__TIME__[7] - 0x30)
 #define BUILD_SECOND ((BUILD_SECOND_0 * 10) + BUILD_SECOND_1)
 
-RV3028::RV3028(void)
+//Holds the lock set with setLock() as long as it exists
+struct RV3028::LockGuard
 {
+	RV3028 *rtc;
+	LockGuard(RV3028 *owner) : rtc(owner) { rtc->lock(); }
+	~LockGuard() { rtc->unlock(); }
+};
+
+//Bits in _timeFlags
+#define TIMEFLAG_12HOUR	0
+#define TIMEFLAG_PM		1
 
+//Seqlock reads before a reader waits for the lock (the writer may have been preempted by the reader)
+#define TIME_SNAPSHOT_RETRIES	16
+
+RV3028::RV3028(void)
+{
+	memset(_time, 0, TIME_ARRAY_LENGTH);
+	_timeFlags = 0;
+	_timeSequence = 0;
+	_lock = NULL;
+	_unlock = NULL;
+	_lockContext = NULL;
+	_batchDepth = 0;
+	_batchCount = 0;
+	_batchEEPROMUpdate = false;
+	_batchSuccess = true;
+	_batchCtrl1 = 0;
+	_batchCtrl1Known = false;
+	resetTelemetry();
+	_statusSeen = 0;
+	_syncValid = false;
+	_syncReference = 0;
+	_softwareHourMode = false;
+	_softwareHour12 = false;
+	_pulseCount = 0;
+	_pulseCountTS = 0;
+	_pulseTime = 0;
+	_pulseRate = 0;
 }
 
-boolean RV3028::begin(TwoWire &wirePort)
+boolean RV3028::begin(TwoWire &wirePort, bool warmStart)
 {
+	LockGuard guard(this);
+
 	//We require caller to begin their I2C port, with the speed of their choice
 	//external to the library
 	//_i2cPort->begin();
 	_i2cPort = &wirePort;
 
-	set24Hour(); delay(1);
+	//Read STATUS up to USER_RAM2 in one burst, readMultipleRegisters() does not clear the status flags
+	uint8_t reg[RV3028_USER_RAM2 - RV3028_STATUS + 1];
+	if (readMultipleRegisters(RV3028_STATUS, reg, sizeof(reg)) == false)
+		return(false);
+	_bootStatus = reg[0];
+
+	//Warm start: Skip the EEPROM configuration if there was no power on reset since the last begin()
+	//The status flags are kept for the application
+	if (warmStart && !(reg[0] & 1 << STATUS_PORF) && !(reg[RV3028_CTRL2 - RV3028_STATUS] & 1 << CTRL2_12_24)
+		&& reg[RV3028_USER_RAM1 - RV3028_STATUS] == RV3028_WARMSTART_FINGERPRINT_1
+		&& reg[RV3028_USER_RAM2 - RV3028_STATUS] == RV3028_WARMSTART_FINGERPRINT_2)
+		return(true);
+
+	//Trickle charger and switchover mode are stored with a single EEPROM Update
+	beginWriteBatch();
+	if (_softwareHourMode == false) set24Hour(); //In software hour mode the RTC is already in 24 hour mode
+	delay(1);
 	disableTrickleCharge(); delay(1);
+	bool success = setBackupSwitchoverMode(3);
+	if (endWriteBatch() == false) success = false;
+
+	if (success == false || writeRegister(RV3028_STATUS, 0x00) == false)
+		return(false);
 
-	return(setBackupSwitchoverMode(3) && writeRegister(RV3028_STATUS, 0x00));
+	if (warmStart)
+	{
+		uint8_t fingerprint[2] = { RV3028_WARMSTART_FINGERPRINT_1, RV3028_WARMSTART_FINGERPRINT_2 };
+		return writeMultipleRegisters(RV3028_USER_RAM1, fingerprint, 2);
+	}
+	return(true);
+}
+
+/*********************************
+Share the RV3028 between several tasks or cores: lock and unlock are called around every bus
+transaction and every read-modify-write sequence. The lock has to be recursive (e.g. a FreeRTOS
+recursive mutex or a pthread mutex with PTHREAD_MUTEX_RECURSIVE). Other devices on the same Wire
+port should use it, too. getDateTime() and the string functions only wait for the lock if they
+preempted a task in the middle of publishing a new time.
+*********************************/
+void RV3028::setLock(void (*lock)(void * context), void (*unlock)(void * context), void * context)
+{
+	_lock = lock;
+	_unlock = unlock;
+	_lockContext = context;
+}
+
+//Calls of other tasks wait until unlock(), nothing happens if no lock is set
+void RV3028::lock()
+{
+	if (_lock != NULL) _lock(_lockContext);
+}
+
+void RV3028::unlock()
+{
+	if (_unlock != NULL) _unlock(_lockContext);
+}
+
+//Returns the status byte read by begin() before anything was changed
+//Check STATUS_PORF for a power on reset and the interrupt flags for the reason of the wake up
+uint8_t RV3028::bootStatus()
+{
+	return(_bootStatus);
 }
 
 bool RV3028::setTime(uint8_t sec, uint8_t min, uint8_t hour, uint8_t weekday, uint8_t date, uint8_t month, uint16_t year)
 {
-	_time[TIME_SECONDS] = DECtoBCD(sec);
-	_time[TIME_MINUTES] = DECtoBCD(min);
-	_time[TIME_HOURS] = DECtoBCD(hour);
-	_time[TIME_WEEKDAY] = DECtoBCD(weekday);
-	_time[TIME_DATE] = DECtoBCD(date);
-	_time[TIME_MONTH] = DECtoBCD(month);
-	_time[TIME_YEAR] = DECtoBCD(year - 2000);
+	uint8_t time[TIME_ARRAY_LENGTH];
+	time[TIME_SECONDS] = DECtoBCD(sec);
+	time[TIME_MINUTES] = DECtoBCD(min);
+	time[TIME_HOURS] = DECtoBCD(hour);
+	time[TIME_WEEKDAY] = DECtoBCD(weekday);
+	time[TIME_DATE] = DECtoBCD(date);
+	time[TIME_MONTH] = DECtoBCD(month);
+	time[TIME_YEAR] = DECtoBCD(year - 2000);
+
+	LockGuard guard(this);
+	writeTimeSnapshot(time, 0);
 
 	bool status = false;
 
-	if (is12Hour())
+	if (_softwareHourMode == false && is12Hour())
 	{
 		set24Hour();
-		status = setTime(_time, TIME_ARRAY_LENGTH);
+		status = setTime(time, TIME_ARRAY_LENGTH);
 		set12Hour();
 	}
 	else
 	{
-		status = setTime(_time, TIME_ARRAY_LENGTH);
+		status = setTime(time, TIME_ARRAY_LENGTH);
 	}
 	return status;
 }
@@ -118,56 +218,73 @@ bool RV3028::setTime(uint8_t * time, uint8_t len)
 
 bool RV3028::setSeconds(uint8_t value)
 {
-	_time[TIME_SECONDS] = DECtoBCD(value);
-	return setTime(_time, TIME_ARRAY_LENGTH);
+	return setTimeField(TIME_SECONDS, DECtoBCD(value));
 }
 
 bool RV3028::setMinutes(uint8_t value)
 {
-	_time[TIME_MINUTES] = DECtoBCD(value);
-	return setTime(_time, TIME_ARRAY_LENGTH);
+	return setTimeField(TIME_MINUTES, DECtoBCD(value));
 }
 
 bool RV3028::setHours(uint8_t value)
 {
-	_time[TIME_HOURS] = DECtoBCD(value);
-	return setTime(_time, TIME_ARRAY_LENGTH);
+	return setTimeField(TIME_HOURS, DECtoBCD(value));
 }
 
 bool RV3028::setWeekday(uint8_t value)
 {
-	_time[TIME_WEEKDAY] = DECtoBCD(value);
-	return setTime(_time, TIME_ARRAY_LENGTH);
+	return setTimeField(TIME_WEEKDAY, DECtoBCD(value));
 }
 
 bool RV3028::setDate(uint8_t value)
 {
-	_time[TIME_DATE] = DECtoBCD(value);
-	return setTime(_time, TIME_ARRAY_LENGTH);
+	return setTimeField(TIME_DATE, DECtoBCD(value));
 }
 
 bool RV3028::setMonth(uint8_t value)
 {
-	_time[TIME_MONTH] = DECtoBCD(value);
-	return setTime(_time, TIME_ARRAY_LENGTH);
+	return setTimeField(TIME_MONTH, DECtoBCD(value));
 }
 
 bool RV3028::setYear(uint16_t value)
 {
-	_time[TIME_YEAR] = DECtoBCD(value - 2000);
-	return setTime(_time, TIME_ARRAY_LENGTH);
+	return setTimeField(TIME_YEAR, DECtoBCD(value - 2000));
+}
+
+//Changes one value of the time read by updateTime() and writes the whole time to the RTC
+bool RV3028::setTimeField(uint8_t field, uint8_t value)
+{
+	LockGuard guard(this);
+
+	uint8_t time[TIME_ARRAY_LENGTH];
+	uint8_t flags;
+	readTimeSnapshot(time, &flags);
+	time[field] = value;
+	writeTimeSnapshot(time, flags);
+
+	return setTime(time, TIME_ARRAY_LENGTH);
 }
 
 //Takes the time from the last build and uses it as the current time
 //Works very well as an arduino sketch
 bool RV3028::setToCompilerTime()
 {
-	_time[TIME_SECONDS] = DECtoBCD(BUILD_SECOND);
-	_time[TIME_MINUTES] = DECtoBCD(BUILD_MINUTE);
-	_time[TIME_HOURS] = DECtoBCD(BUILD_HOUR);
+	uint8_t time[TIME_ARRAY_LENGTH];
+	time[TIME_SECONDS] = DECtoBCD(BUILD_SECOND);
+	time[TIME_MINUTES] = DECtoBCD(BUILD_MINUTE);
+	time[TIME_HOURS] = DECtoBCD(BUILD_HOUR);
+
+	time[TIME_WEEKDAY] = DECtoBCD(weekdayFromDate(BUILD_YEAR, BUILD_MONTH, BUILD_DATE) + 1); //Written as 1 to 7 as always
+
+	time[TIME_DATE] = DECtoBCD(BUILD_DATE);
+	time[TIME_MONTH] = DECtoBCD(BUILD_MONTH);
+	time[TIME_YEAR] = DECtoBCD(BUILD_YEAR - 2000); //! Not Y2K (or Y2.1K)-proof :(
+
+	LockGuard guard(this);
+	writeTimeSnapshot(time, 0);
 
 	//Build_Hour is 0-23, convert to 1-12 if needed
-	if (is12Hour())
+	if (_softwareHourMode == false && is12Hour())
 	{
 		uint8_t hour = BUILD_HOUR;
 
@@ -183,24 +300,12 @@ bool RV3028::setToCompilerTime()
 			pm = true;
 		}
 
-		_time[TIME_HOURS] = DECtoBCD(hour); //Load the modified hours
+		time[TIME_HOURS] = DECtoBCD(hour); //Load the modified hours
 
-		if (pm == true) _time[TIME_HOURS] |= (1 << HOURS_AM_PM); //Set AM/PM bit if needed
+		if (pm == true) time[TIME_HOURS] |= (1 << HOURS_AM_PM); //Set AM/PM bit if needed
 	}
 
-	// Calculate weekday (from here: http://stackoverflow.com/a/21235587)
-	// 0 = Sunday, 6 = Saturday
-	uint16_t d = BUILD_DATE;
-	uint16_t m = BUILD_MONTH;
-	uint16_t y = BUILD_YEAR;
-	uint16_t weekday = (d += m < 3 ? y-- : y - 2, 23 * m / 9 + d + 4 + y / 4 - y / 100 + y / 400) % 7 + 1;
-	_time[TIME_WEEKDAY] = DECtoBCD(weekday);
-
-	_time[TIME_DATE] = DECtoBCD(BUILD_DATE);
-	_time[TIME_MONTH] = DECtoBCD(BUILD_MONTH);
-	_time[TIME_YEAR] = DECtoBCD(BUILD_YEAR - 2000); //! Not Y2K (or Y2.1K)-proof :(
-
-	return setTime(_time, TIME_ARRAY_LENGTH);
+	return setTime(time, TIME_ARRAY_LENGTH);
 }
 
 //Move the hours, mins, sec, etc registers from RV-3028-C7 into the _time array
@@ -208,10 +313,20 @@ bool RV3028::setToCompilerTime()
 //We do not protect the GPx registers. They will be overwritten. The user has plenty of RAM if they need it.
 bool RV3028::updateTime()
 {
-	if (readMultipleRegisters(RV3028_SECONDS, _time, TIME_ARRAY_LENGTH) == false)
+	LockGuard guard(this);
+
+	uint8_t time[TIME_ARRAY_LENGTH];
+	if (readMultipleRegisters(RV3028_SECONDS, time, TIME_ARRAY_LENGTH) == false)
 		return(false); //Something went wrong
 
-	if (is12Hour()) _time[TIME_HOURS] &= ~(1 << HOURS_AM_PM); //Remove this bit from value
+	uint8_t flags = 0;
+	if (_softwareHourMode == false && is12Hour())
+	{
+		flags |= 1 << TIMEFLAG_12HOUR;
+		if (time[TIME_HOURS] & (1 << HOURS_AM_PM)) flags |= 1 << TIMEFLAG_PM;
+		time[TIME_HOURS] &= ~(1 << HOURS_AM_PM); //Remove this bit from value
+	}
+	writeTimeSnapshot(time, flags);
 
 	return true;
 }
@@ -219,16 +334,34 @@ bool RV3028::updateTime()
 //Returns a pointer to array of chars that are the date in mm/dd/yyyy format because they're weird
 char* RV3028::stringDateUSA()
 {
-	static char date[11]; //Max of mm/dd/yyyy with \0 terminator
-	sprintf(date, "%02hhu/%02hhu/20%02hhu", BCDtoDEC(_time[TIME_MONTH]), BCDtoDEC(_time[TIME_DATE]), BCDtoDEC(_time[TIME_YEAR]));
+	static char date[STRING_DATE_LENGTH]; //Max of mm/dd/yyyy with \0 terminator
+	return(stringDateUSA(date));
+}
+
+char* RV3028::stringDateUSA(char * date)
+{
+	uint8_t time[TIME_ARRAY_LENGTH];
+	uint8_t flags;
+	readTimeSnapshot(time, &flags);
+
+	sprintf(date, "%02hhu/%02hhu/20%02hhu", BCDtoDEC(time[TIME_MONTH]), BCDtoDEC(time[TIME_DATE]), BCDtoDEC(time[TIME_YEAR]));
 	return(date);
 }
 
 //Returns a pointer to array of chars that are the date in dd/mm/yyyy format
 char*  RV3028::stringDate()
 {
-	static char date[11]; //Max of dd/mm/yyyy with \0 terminator
-	sprintf(date, "%02hhu/%02hhu/20%02hhu", BCDtoDEC(_time[TIME_DATE]), BCDtoDEC(_time[TIME_MONTH]), BCDtoDEC(_time[TIME_YEAR]));
+	static char date[STRING_DATE_LENGTH]; //Max of dd/mm/yyyy with \0 terminator
+	return(stringDate(date));
+}
+
+char* RV3028::stringDate(char * date)
+{
+	uint8_t time[TIME_ARRAY_LENGTH];
+	uint8_t flags;
+	readTimeSnapshot(time, &flags);
+
+	sprintf(date, "%02hhu/%02hhu/20%02hhu", BCDtoDEC(time[TIME_DATE]), BCDtoDEC(time[TIME_MONTH]), BCDtoDEC(time[TIME_YEAR]));
 	return(date);
 }
 
@@ -236,36 +369,124 @@ char*  RV3028::stringDate()
 //Adds AM/PM if in 12 hour mode
 char* RV3028::stringTime()
 {
-	static char time[11]; //Max of hh:mm:ssXM with \0 terminator
-
-	if (is12Hour() == true)
-	{
-		char half = 'A';
-		if (isPM()) half = 'P';
+	static char time[STRING_DATE_LENGTH]; //Max of hh:mm:ssXM with \0 terminator
+	return(stringTime(time));
+}
 
-		sprintf(time, "%02hhu:%02hhu:%02hhu%cM", BCDtoDEC(_time[TIME_HOURS]), BCDtoDEC(_time[TIME_MINUTES]), BCDtoDEC(_time[TIME_SECONDS]), half);
-	}
+char* RV3028::stringTime(char * buffer)
+{
+	uint8_t time[TIME_ARRAY_LENGTH];
+	uint8_t flags;
+	readTimeSnapshot(time, &flags);
+
+	char half;
+	uint8_t hours = displayHours(time, flags, &half);
+	if (half != 0)
+		sprintf(buffer, "%02hhu:%02hhu:%02hhu%cM", hours, BCDtoDEC(time[TIME_MINUTES]), BCDtoDEC(time[TIME_SECONDS]), half);
 	else
-		sprintf(time, "%02hhu:%02hhu:%02hhu", BCDtoDEC(_time[TIME_HOURS]), BCDtoDEC(_time[TIME_MINUTES]), BCDtoDEC(_time[TIME_SECONDS]));
+		sprintf(buffer, "%02hhu:%02hhu:%02hhu", hours, BCDtoDEC(time[TIME_MINUTES]), BCDtoDEC(time[TIME_SECONDS]));
 
-	return(time);
+	return(buffer);
 }
 
 char* RV3028::stringTimeStamp()
 {
-	static char timeStamp[25]; //Max of yyyy-mm-ddThh:mm:ss.ss with \0 terminator
+	static char timeStamp[STRING_TIMESTAMP_LENGTH]; //Max of yyyy-mm-ddThh:mm:ss.ss with \0 terminator
+	return(stringTimeStamp(timeStamp));
+}
 
-	if (is12Hour() == true)
+char* RV3028::stringTimeStamp(char * timeStamp)
+{
+	uint8_t time[TIME_ARRAY_LENGTH];
+	uint8_t flags;
+	readTimeSnapshot(time, &flags);
+
+	char half;
+	uint8_t hours = displayHours(time, flags, &half);
+	if (half != 0)
+		sprintf(timeStamp, "20%02hhu-%02hhu-%02hhu  %02hhu:%02hhu:%02hhu%cM", BCDtoDEC(time[TIME_YEAR]), BCDtoDEC(time[TIME_MONTH]), BCDtoDEC(time[TIME_DATE]), hours, BCDtoDEC(time[TIME_MINUTES]), BCDtoDEC(time[TIME_SECONDS]), half);
+	else
+		sprintf(timeStamp, "20%02hhu-%02hhu-%02hhu  %02hhu:%02hhu:%02hhu", BCDtoDEC(time[TIME_YEAR]), BCDtoDEC(time[TIME_MONTH]), BCDtoDEC(time[TIME_DATE]), hours, BCDtoDEC(time[TIME_MINUTES]), BCDtoDEC(time[TIME_SECONDS]));
+
+	return(timeStamp);
+}
+
+//Hours of a time snapshot as printed by the string functions
+//half is 'A' or 'P' in 12 hour format, else 0
+uint8_t RV3028::displayHours(const uint8_t * time, uint8_t flags, char * half)
+{
+	uint8_t hour = BCDtoDEC(time[TIME_HOURS]);
+	*half = 0;
+
+	if (_softwareHourMode)
 	{
-		char half = 'A';
-		if (isPM()) half = 'P';
+		if (_softwareHour12)
+		{
+			*half = hour >= 12 ? 'P' : 'A';
+			hour %= 12;
+			if (hour == 0) hour = 12;
+		}
+	}
+	else if (flags & 1 << TIMEFLAG_12HOUR)
+		*half = (flags & 1 << TIMEFLAG_PM) ? 'P' : 'A';
 
-		sprintf(timeStamp, "20%02hhu-%02hhu-%02hhu  %02hhu:%02hhu:%02hhu%cM", BCDtoDEC(_time[TIME_YEAR]), BCDtoDEC(_time[TIME_MONTH]), BCDtoDEC(_time[TIME_DATE]), BCDtoDEC(_time[TIME_HOURS]), BCDtoDEC(_time[TIME_MINUTES]), BCDtoDEC(_time[TIME_SECONDS]), half);
+	return hour;
+}
+
+//Returns the time read by updateTime() in 24 hour format
+//Never accesses the bus, so it is safe to call while another task uses the RTC
+RV3028_DateTime RV3028::getDateTime()
+{
+	uint8_t time[TIME_ARRAY_LENGTH];
+	uint8_t flags;
+	readTimeSnapshot(time, &flags);
+
+	RV3028_DateTime dateTime;
+	dateTime.seconds = BCDtoDEC(time[TIME_SECONDS]);
+	dateTime.minutes = BCDtoDEC(time[TIME_MINUTES]);
+	dateTime.hours = BCDtoDEC(time[TIME_HOURS]);
+	if (flags & 1 << TIMEFLAG_12HOUR)
+	{
+		dateTime.hours %= 12; //12AM is 0
+		if (flags & 1 << TIMEFLAG_PM) dateTime.hours += 12;
 	}
-	else
-		sprintf(timeStamp, "20%02hhu-%02hhu-%02hhu  %02hhu:%02hhu:%02hhu", BCDtoDEC(_time[TIME_YEAR]), BCDtoDEC(_time[TIME_MONTH]), BCDtoDEC(_time[TIME_DATE]), BCDtoDEC(_time[TIME_HOURS]), BCDtoDEC(_time[TIME_MINUTES]), BCDtoDEC(_time[TIME_SECONDS]));
+	dateTime.weekday = BCDtoDEC(time[TIME_WEEKDAY]);
+	dateTime.date = BCDtoDEC(time[TIME_DATE]);
+	dateTime.month = BCDtoDEC(time[TIME_MONTH]);
+	dateTime.year = BCDtoDEC(time[TIME_YEAR]) + 2000;
 
-	return(timeStamp);
+	return dateTime;
+}
+
+//Seqlock: Readers copy _time again until no write happened meanwhile, so they never wait for the bus.
+//On a single core a reader with higher priority than the writer would spin forever, so after
+//TIME_SNAPSHOT_RETRIES it takes the lock, which the writer holds while publishing.
+void RV3028::readTimeSnapshot(uint8_t * time, uint8_t * flags)
+{
+	for (uint8_t retry = 0; retry < TIME_SNAPSHOT_RETRIES; retry++)
+	{
+		uint8_t sequence = _timeSequence;
+		RV3028_MEMORY_BARRIER();
+		memcpy(time, _time, TIME_ARRAY_LENGTH);
+		*flags = _timeFlags;
+		RV3028_MEMORY_BARRIER();
+		if ((sequence & 1) == 0 && sequence == _timeSequence) return;
+	}
+
+	LockGuard guard(this);
+	memcpy(time, _time, TIME_ARRAY_LENGTH);
+	*flags = _timeFlags;
+}
+
+//Writers have to hold the lock
+void RV3028::writeTimeSnapshot(const uint8_t * time, uint8_t flags)
+{
+	_timeSequence++;
+	RV3028_MEMORY_BARRIER();
+	memcpy(_time, time, TIME_ARRAY_LENGTH);
+	_timeFlags = flags;
+	RV3028_MEMORY_BARRIER();
+	_timeSequence++;
 }
 
 uint8_t RV3028::getSeconds()
@@ -280,7 +501,15 @@ uint8_t RV3028::getMinutes()
 
 uint8_t RV3028::getHours()
 {
-	return BCDtoDEC(_time[TIME_HOURS]);
+	uint8_t hour = BCDtoDEC(_time[TIME_HOURS]);
+
+	//Convert 0-23 to 1-12 in software hour mode
+	if (_softwareHourMode && _softwareHour12)
+	{
+		hour %= 12;
+		if (hour == 0) hour = 12;
+	}
+	return hour;
 }
 
 uint8_t RV3028::getWeekday()
@@ -304,27 +533,47 @@ uint16_t RV3028::getYear()
 }
 
 //Returns true if RTC has been configured for 12 hour mode
+//In software hour mode true if 12 hour format was selected with set12Hour()
 bool RV3028::is12Hour()
+{
+	if (_softwareHourMode) return(_softwareHour12);
+	return(hardware12Hour());
+}
+
+bool RV3028::hardware12Hour()
 {
 	uint8_t controlRegister2 = readRegister(RV3028_CTRL2);
 	return(controlRegister2 & (1 << CTRL2_12_24));
 }
 
-//Returns true if RTC has PM bit set and 12Hour bit set
+//Returns true if the time read by updateTime() is PM and the RTC was in 12 hour mode
+//In software hour mode true if 12 hour format is selected and the time read by updateTime() is PM
+//Never accesses the bus, like the string functions
 bool RV3028::isPM()
 {
-	uint8_t hourRegister = readRegister(RV3028_HOURS);
-	if (is12Hour() && (hourRegister & (1 << HOURS_AM_PM)))
-		return(true);
-	return(false);
+	uint8_t time[TIME_ARRAY_LENGTH];
+	uint8_t flags;
+	readTimeSnapshot(time, &flags);
+
+	if (_softwareHourMode) return(_softwareHour12 && BCDtoDEC(time[TIME_HOURS]) >= 12);
+	return((flags & 1 << TIMEFLAG_12HOUR) && (flags & 1 << TIMEFLAG_PM));
 }
 
 //Configure RTC to output 1-12 hours
 //Converts any current hour setting to 12 hour
+//In software hour mode only the getters and strings change, the RTC stays in 24 hour mode
 void RV3028::set12Hour()
 {
+	LockGuard guard(this);
+
+	if (_softwareHourMode)
+	{
+		_softwareHour12 = true;
+		return;
+	}
+
 	//Do we need to change anything?
-	if (is12Hour() == false)
+	if (hardware12Hour() == false)
 	{
 		uint8_t hour = BCDtoDEC(readRegister(RV3028_HOURS)); //Get the current hour in the RTC
 
@@ -356,10 +605,19 @@ void RV3028::set12Hour()
 
 //Configure RTC to output 0-23 hours
 //Converts any current hour setting to 24 hour
+//In software hour mode only the getters and strings change
 void RV3028::set24Hour()
 {
+	LockGuard guard(this);
+
+	if (_softwareHourMode)
+	{
+		_softwareHour12 = false;
+		return;
+	}
+
 	//Do we need to change anything?
-	if (is12Hour() == true)
+	if (hardware12Hour() == true)
 	{
 		//Not sure what changing the CTRL2 register will do to hour register so let's get a copy
 		uint8_t hour = readRegister(RV3028_HOURS); //Get the current 12 hour formatted time in BCD
@@ -388,6 +646,35 @@ void RV3028::set24Hour()
 	}
 }
 
+/*********************************
+Software hour mode: The RTC always runs in 24 hour mode and the 12 hour format
+(set12Hour(), is12Hour(), isPM(), getHours() and the strings) is handled in software.
+setTime(), setToCompilerTime() and the alarm take 24 hour values and do not need to switch
+the mode of the RTC. isPM() uses the time read by updateTime(). Call after begin().
+*********************************/
+void RV3028::enableSoftwareHourMode()
+{
+	LockGuard guard(this);
+
+	if (_softwareHourMode) return;
+
+	bool twelveHour = hardware12Hour();
+	if (twelveHour) set24Hour(); //Converts the hours register of the RTC to 24 hour
+	_softwareHour12 = twelveHour;
+	_softwareHourMode = true;
+}
+
+//Switches the RTC to the 12 or 24 hour mode that was selected in software hour mode
+void RV3028::disableSoftwareHourMode()
+{
+	LockGuard guard(this);
+
+	if (_softwareHourMode == false) return;
+
+	_softwareHourMode = false;
+	if (_softwareHour12) set12Hour();
+}
+
 //ATTENTION: Real Time and UNIX Time are INDEPENDENT!
 bool RV3028::setUNIX(uint32_t value)
 {
@@ -408,6 +695,61 @@ uint32_t RV3028::getUNIX()
 	return ((uint32_t)unix_reg[3] << 24) | ((uint32_t)unix_reg[2] << 16) | ((uint32_t)unix_reg[1] << 8) | unix_reg[0];
 }
 
+//Seconds since 1970-01-01 00:00:00 of dateTime, the weekday is ignored
+//Independent of the UNIX Time registers, e.g. to compare the real time with the UNIX Time
+uint32_t RV3028::dateTimeToUNIX(const RV3028_DateTime &dateTime)
+{
+	return (uint32_t)daysFromDate(dateTime.year, dateTime.month, dateTime.date) * 86400UL
+		+ (uint32_t)dateTime.hours * 3600UL + (uint16_t)dateTime.minutes * 60 + dateTime.seconds;
+}
+
+//Date and time of seconds since 1970-01-01 00:00:00
+RV3028_DateTime RV3028::UNIXtoDateTime(uint32_t value)
+{
+	RV3028_DateTime dateTime;
+	uint32_t days = value / 86400UL;
+	uint32_t secondsOfDay = value % 86400UL;
+
+	dateTime.seconds = secondsOfDay % 60;
+	dateTime.minutes = (secondsOfDay / 60) % 60;
+	dateTime.hours = secondsOfDay / 3600;
+	dateTime.weekday = (days + 4) % 7; //1970-01-01 was a Thursday
+
+	//Civil from days (from here: http://howardhinnant.github.io/date_algorithms.html)
+	uint32_t z = days + 719468;
+	uint32_t era = z / 146097;
+	uint32_t doe = z - era * 146097;										//Day of era [0, 146096]
+	uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;	//Year of era [0, 399]
+	uint16_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);					//Day of year starting March 1st [0, 365]
+	uint8_t mp = (5 * doy + 2) / 153;										//Month starting March [0, 11]
+	dateTime.date = doy - (153 * mp + 2) / 5 + 1;
+	dateTime.month = mp < 10 ? mp + 3 : mp - 9;
+	dateTime.year = yoe + era * 400 + (dateTime.month <= 2);
+
+	return dateTime;
+}
+
+//Days since 1970-01-01 (from here: http://howardhinnant.github.io/date_algorithms.html)
+int32_t RV3028::daysFromDate(uint16_t year, uint8_t month, uint8_t date)
+{
+	if (month <= 2) year--;
+	uint16_t era = year / 400;
+	uint16_t yoe = year - era * 400;											//Year of era [0, 399]
+	uint16_t doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + date - 1;	//Day of year starting March 1st [0, 365]
+	uint32_t doe = (uint32_t)yoe * 365 + yoe / 4 - yoe / 100 + doy;				//Day of era [0, 146096]
+	return (int32_t)era * 146097 + (int32_t)doe - 719468;
+}
+
+// Calculate weekday (from here: http://stackoverflow.com/a/21235587)
+// 0 = Sunday, 6 = Saturday
+uint8_t RV3028::weekdayFromDate(uint16_t year, uint8_t month, uint8_t date)
+{
+	uint16_t d = date;
+	uint16_t m = month;
+	uint16_t y = year;
+	return (d += m < 3 ? y-- : y - 2, 23 * m / 9 + d + 4 + y / 4 - y / 100 + y / 400) % 7;
+}
+
 /*********************************
 Set the alarm mode in the following way:
 0: When minutes, hours and weekday/date match (once per weekday/date)
@@ -422,11 +764,13 @@ If you want to set a weekday alarm (setWeekdayAlarm_not_Date = true), set 'date_
 ********************************/
 void RV3028::enableAlarmInterrupt(uint8_t min, uint8_t hour, uint8_t date_or_weekday, bool setWeekdayAlarm_not_Date, uint8_t mode)
 {
+	LockGuard guard(this);
+
 	//disable Alarm Interrupt to prevent accidental interrupts during configuration
 	disableAlarmInterrupt(); clearInterrupts();
 
-	//ENHANCEMENT: Add Alarm in 12 hour mode
-	set24Hour();
+	//ENHANCEMENT: Add Alarm in 12 hour mode (in software hour mode the RTC is always in 24 hour mode)
+	if (_softwareHourMode == false) set24Hour();
 	//Set WADA bit (Weekday/Date Alarm)
 	uint8_t value = readRegister(RV3028_CTRL1);
 	if (setWeekdayAlarm_not_Date)
@@ -457,6 +801,8 @@ void RV3028::enableAlarmInterrupt(uint8_t min, uint8_t hour, uint8_t date_or_wee
 
 void RV3028::enableAlarmInterrupt()
 {
+	LockGuard guard(this);
+
 	uint8_t value = readRegister(RV3028_CTRL2);
 	value |= (1 << CTRL2_AIE); //Set the interrupt enable bit
 	writeRegister(RV3028_CTRL2, value);
@@ -465,6 +811,8 @@ void RV3028::enableAlarmInterrupt()
 //Only disables the interrupt (not the alarm flag)
 void RV3028::disableAlarmInterrupt()
 {
+	LockGuard guard(this);
+
 	uint8_t value = readRegister(RV3028_CTRL2);
 	value &= ~(1 << CTRL2_AIE); //Clear the interrupt enable bit
 	writeRegister(RV3028_CTRL2, value);
@@ -476,6 +824,358 @@ bool RV3028::readAlarmInterruptFlag()
 	return (stat & (1 << STATUS_AF));
 }
 
+/*********************************
+Set alarm, mode and alarm interrupt like enableAlarmInterrupt(), but with less bus traffic:
+The alarm registers and CTRL1/CTRL2 are read in one burst and nothing is written if the
+alarm is already set. Otherwise only the changed register range is written in one burst
+(plus disabling the interrupt first if it was enabled) and only the alarm flag is cleared.
+The hours are always given in 24 hour format and converted if the RTC is in 12 hour mode.
+*********************************/
+bool RV3028::setAlarm(const RV3028_Alarm &alarm)
+{
+	LockGuard guard(this);
+
+	//Registers 0x07 (MINUTES_ALM) to 0x10 (CTRL2)
+	uint8_t reg[RV3028_CTRL2 - RV3028_MINUTES_ALM + 1];
+	if (readMultipleRegisters(RV3028_MINUTES_ALM, reg, sizeof(reg)) == false)
+		return false;
+	uint8_t * ctrl1 = &reg[RV3028_CTRL1 - RV3028_MINUTES_ALM];
+	uint8_t * ctrl2 = &reg[RV3028_CTRL2 - RV3028_MINUTES_ALM];
+
+	uint8_t target[sizeof(reg)];
+	memcpy(target, reg, sizeof(reg));
+
+	//Alarm registers
+	uint8_t hour = alarm.hours;
+	bool pm = false;
+	if (*ctrl2 & 1 << CTRL2_12_24)
+	{
+		pm = hour >= 12;
+		hour %= 12;
+		if (hour == 0) hour = 12;
+	}
+	target[0] = DECtoBCD(alarm.minutes);
+	target[1] = DECtoBCD(hour);
+	if (pm) target[1] |= 1 << HOURS_AM_PM;
+	target[2] = DECtoBCD(alarm.date_or_weekday);
+	uint8_t mode = alarm.mode > 0b111 ? 0b111 : alarm.mode; //0 to 7 is valid
+	if (mode & 0b001)
+		target[0] |= 1 << MINUTESALM_AE_M;
+	if (mode & 0b010)
+		target[1] |= 1 << HOURSALM_AE_H;
+	if (mode & 0b100)
+		target[2] |= 1 << DATE_AE_WD;
+
+	//WADA bit (Weekday/Date Alarm) and interrupt enable bit
+	uint8_t * targetCtrl1 = &target[RV3028_CTRL1 - RV3028_MINUTES_ALM];
+	uint8_t * targetCtrl2 = &target[RV3028_CTRL2 - RV3028_MINUTES_ALM];
+	if (alarm.weekdayAlarm)
+		*targetCtrl1 &= ~(1 << CTRL1_WADA);
+	else
+		*targetCtrl1 |= 1 << CTRL1_WADA;
+	if (alarm.interrupt)
+		*targetCtrl2 |= 1 << CTRL2_AIE;
+	else
+		*targetCtrl2 &= ~(1 << CTRL2_AIE);
+
+	bool alarmChanged = memcmp(reg, target, 3) != 0 || *ctrl1 != *targetCtrl1;
+	bool success = true;
+
+	//Writing 1 to a status flag has no effect, only the alarm flag of the old alarm is cleared
+	uint8_t * targetStatus = &target[RV3028_STATUS - RV3028_MINUTES_ALM];
+	*targetStatus = alarmChanged ? (uint8_t)~(1 << STATUS_AF) : 0xFF;
+	reg[RV3028_STATUS - RV3028_MINUTES_ALM] = 0xFF;
+
+	if (alarmChanged && (*ctrl2 & 1 << CTRL2_AIE))
+	{
+		//Disable Alarm Interrupt to prevent accidental interrupts during configuration
+		*ctrl2 &= ~(1 << CTRL2_AIE);
+		if (!writeRegister(RV3028_CTRL2, *ctrl2)) success = false;
+	}
+
+	//Write the range from the first to the last changed register in one burst
+	uint8_t first = 0;
+	uint8_t last = sizeof(reg);
+	while (first < last && reg[first] == target[first]) first++;
+	while (last > first && reg[last - 1] == target[last - 1]) last--;
+	if (first < last && !writeMultipleRegisters(RV3028_MINUTES_ALM + first, target + first, last - first)) success = false;
+
+	return success;
+}
+
+//Read alarm, mode and alarm interrupt enable in one burst, the hours are in 24 hour format
+bool RV3028::getAlarm(RV3028_Alarm &alarm)
+{
+	//Registers 0x07 (MINUTES_ALM) to 0x10 (CTRL2)
+	uint8_t reg[RV3028_CTRL2 - RV3028_MINUTES_ALM + 1];
+	if (readMultipleRegisters(RV3028_MINUTES_ALM, reg, sizeof(reg)) == false)
+		return false;
+	uint8_t ctrl1 = reg[RV3028_CTRL1 - RV3028_MINUTES_ALM];
+	uint8_t ctrl2 = reg[RV3028_CTRL2 - RV3028_MINUTES_ALM];
+
+	alarm.minutes = BCDtoDEC(reg[0] & ~(1 << MINUTESALM_AE_M));
+	if (ctrl2 & 1 << CTRL2_12_24)
+	{
+		alarm.hours = BCDtoDEC(reg[1] & ~(1 << HOURSALM_AE_H | 1 << HOURS_AM_PM)) % 12; //12AM is 0
+		if (reg[1] & 1 << HOURS_AM_PM) alarm.hours += 12;
+	}
+	else
+		alarm.hours = BCDtoDEC(reg[1] & ~(1 << HOURSALM_AE_H));
+	alarm.date_or_weekday = BCDtoDEC(reg[2] & ~(1 << DATE_AE_WD));
+	alarm.weekdayAlarm = !(ctrl1 & 1 << CTRL1_WADA);
+	alarm.mode = (reg[0] >> MINUTESALM_AE_M & 1) | (reg[1] >> HOURSALM_AE_H & 1) << 1 | (reg[2] >> DATE_AE_WD & 1) << 2;
+	alarm.interrupt = ctrl2 & 1 << CTRL2_AIE;
+
+	return true;
+}
+
+/*********************************
+Count pulses on the EVI pin with the time stamp counter of the RTC, the MCU can sleep meanwhile
+risingEdge: true counts rising edges, false counts falling edges
+filter: Event filtering time of EVI
+EVENT_FILTER_OFF    = No filtering
+EVENT_FILTER_3_9MS  = 3.9ms
+EVENT_FILTER_15_6MS = 15.6ms
+EVENT_FILTER_125MS  = 125ms
+The RTC counts up to 255 pulses, call updatePulseCounter() before more pulses occur.
+*********************************/
+bool RV3028::enablePulseCounter(bool risingEdge, uint8_t filter)
+{
+	LockGuard guard(this);
+
+	if (filter > 3) return false;
+
+	//Registers 0x10 (CTRL2) to 0x13 (EVENTCTRL) in one burst
+	uint8_t reg[RV3028_EVENTCTRL - RV3028_CTRL2 + 1];
+	if (readMultipleRegisters(RV3028_CTRL2, reg, sizeof(reg)) == false)
+		return false;
+
+	//Time stamp source EVI, overwrite with the last event, reset counter and time stamp
+	uint8_t eventControl = reg[RV3028_EVENTCTRL - RV3028_CTRL2] & 0b10001000; //Keep not implemented bits
+	if (risingEdge) eventControl |= 1 << EVENTCTRL_EHL;
+	eventControl |= filter << EVENTCTRL_ET;
+	eventControl |= 1 << EVENTCTRL_TSR | 1 << EVENTCTRL_TSOW;
+	reg[RV3028_EVENTCTRL - RV3028_CTRL2] = eventControl;
+	//Enable time stamp
+	reg[0] |= 1 << CTRL2_TSE;
+
+	_pulseCount = 0;
+	_pulseCountTS = 0;
+	_pulseTime = 0;
+	_pulseRate = 0;
+
+	return writeMultipleRegisters(RV3028_CTRL2, reg, sizeof(reg));
+}
+
+void RV3028::disablePulseCounter()
+{
+	LockGuard guard(this);
+
+	uint8_t value = readRegister(RV3028_CTRL2);
+	value &= ~(1 << CTRL2_TSE); //Clear the time stamp enable bit
+	writeRegister(RV3028_CTRL2, value);
+}
+
+void RV3028::resetPulseCounter()
+{
+	LockGuard guard(this);
+
+	uint8_t value = readRegister(RV3028_EVENTCTRL);
+	value |= 1 << EVENTCTRL_TSR; //Reset counter and time stamp
+	writeRegister(RV3028_EVENTCTRL, value);
+
+	_pulseCount = 0;
+	_pulseCountTS = 0;
+	_pulseTime = 0;
+	_pulseRate = 0;
+}
+
+//Read the counter and the time of the last pulse from the RTC in one burst
+//Needs to be called before getPulseCount(), getPulseTime() or getPulseRate()
+bool RV3028::updatePulseCounter()
+{
+	LockGuard guard(this);
+
+	//Registers 0x00 (SECONDS) to 0x1A (YEAR_TS), real time for the rate without new pulses, CTRL2 for the 12/24 hour bit
+	uint8_t reg[RV3028_YEAR_TS + 1];
+	if (readMultipleRegisters(RV3028_SECONDS, reg, sizeof(reg)) == false)
+		return false;
+	uint8_t * timeStamp = &reg[RV3028_SECONDS_TS];
+	bool twelveHour = reg[RV3028_CTRL2] & 1 << CTRL2_12_24;
+
+	//Extend the 8 bit counter, the difference is correct across an overflow
+	uint8_t countTS = reg[RV3028_COUNT_TS];
+	uint8_t pulses = countTS - _pulseCountTS;
+	_pulseCountTS = countTS;
+	if (pulses == 0)
+	{
+		if (_pulseTime == 0) return true;
+
+		//No pulse since _pulseTime: the rate is at most one pulse per elapsed time, so it falls to 0 when the meter stops
+		RV3028_DateTime now;
+		now.seconds = BCDtoDEC(reg[RV3028_SECONDS]);
+		now.minutes = BCDtoDEC(reg[RV3028_MINUTES]);
+		if (twelveHour)
+		{
+			now.hours = BCDtoDEC(reg[RV3028_HOURS] & ~(1 << HOURS_AM_PM)) % 12; //12AM is 0
+			if (reg[RV3028_HOURS] & 1 << HOURS_AM_PM) now.hours += 12;
+		}
+		else
+			now.hours = BCDtoDEC(reg[RV3028_HOURS]);
+		now.date = BCDtoDEC(reg[RV3028_DATE]);
+		now.month = BCDtoDEC(reg[RV3028_MONTHS]);
+		now.year = BCDtoDEC(reg[RV3028_YEARS]) + 2000;
+		uint32_t elapsed = dateTimeToUNIX(now) - _pulseTime;
+		if ((int32_t)elapsed > 0 && _pulseRate > 1.0 / elapsed)
+			_pulseRate = 1.0 / elapsed;
+		return true;
+	}
+	_pulseCount += pulses;
+
+	RV3028_DateTime dateTime;
+	dateTime.seconds = BCDtoDEC(timeStamp[0]);
+	dateTime.minutes = BCDtoDEC(timeStamp[1]);
+	if (twelveHour)
+	{
+		dateTime.hours = BCDtoDEC(timeStamp[2] & ~(1 << HOURS_AM_PM)) % 12; //12AM is 0
+		if (timeStamp[2] & 1 << HOURS_AM_PM) dateTime.hours += 12;
+	}
+	else
+		dateTime.hours = BCDtoDEC(timeStamp[2]);
+	dateTime.date = BCDtoDEC(timeStamp[3]);
+	dateTime.month = BCDtoDEC(timeStamp[4]);
+	dateTime.year = BCDtoDEC(timeStamp[5]) + 2000;
+	uint32_t pulseTime = dateTimeToUNIX(dateTime);
+
+	//Rate between the last pulses of the previous and this reading
+	if (_pulseTime != 0 && pulseTime > _pulseTime)
+		_pulseRate = (float)pulses / (pulseTime - _pulseTime);
+	_pulseTime = pulseTime;
+
+	return true;
+}
+
+uint32_t RV3028::getPulseCount()
+{
+	return _pulseCount;
+}
+
+//Time of the last pulse (real time of the RTC) in seconds since 1970-01-01, 0 if there was none
+uint32_t RV3028::getPulseTime()
+{
+	return _pulseTime;
+}
+
+//Pulses per second between the last pulses of the last two readings with new pulses
+//A reading without new pulses lowers it to at most one pulse per second since the last pulse
+//0 until two readings with new pulses were made
+float RV3028::getPulseRate()
+{
+	return _pulseRate;
+}
+
+/*********************************
+Telemetry: Counts power on resets and backup switchovers seen in any status register read, bus errors,
+EEPROM timeouts and the time waited for the EEPROM. The counters wrap around, compare them between uplinks.
+resync() sets real time and UNIX Time to a reference (e.g. NTP or GPS) and starts a drift measurement,
+updateTelemetry() measures the drift against the reference once TELEMETRY_MIN_DRIFT_SECONDS passed
+and the offset between real time and UNIX Time, which stays constant unless one of them was changed.
+*********************************/
+bool RV3028::updateTelemetry(uint32_t reference)
+{
+	uint32_t unixTime;
+	return measureTime(reference, &unixTime);
+}
+
+bool RV3028::resync(uint32_t reference)
+{
+	LockGuard guard(this);
+
+	uint32_t unixTime;
+	if (measureTime(reference, &unixTime))
+	{
+		int32_t correction = (int32_t)(reference - unixTime);
+		_telemetry.lastCorrection = constrain(correction, -32768L, 32767L);
+	}
+
+	RV3028_DateTime dateTime = UNIXtoDateTime(reference);
+	if (setTime(dateTime.seconds, dateTime.minutes, dateTime.hours, dateTime.weekday, dateTime.date, dateTime.month, dateTime.year) == false
+		|| setUNIX(reference) == false)
+		return false;
+
+	_telemetry.resyncs++;
+	_syncReference = reference;
+	_syncValid = true;
+	return true;
+}
+
+RV3028_Telemetry RV3028::getTelemetry()
+{
+	LockGuard guard(this);
+	return _telemetry;
+}
+
+void RV3028::resetTelemetry()
+{
+	LockGuard guard(this);
+	memset(&_telemetry, 0, sizeof(_telemetry));
+}
+
+//Reads real time and UNIX Time in one burst and updates drift and calendar offset
+bool RV3028::measureTime(uint32_t reference, uint32_t * unixTime)
+{
+	LockGuard guard(this);
+
+	uint8_t reg[RV3028_UNIX_TIME3 + 1];
+	if (readMultipleRegisters(RV3028_SECONDS, reg, sizeof(reg)) == false)
+		return false;
+
+	*unixTime = ((uint32_t)reg[RV3028_UNIX_TIME3] << 24) | ((uint32_t)reg[RV3028_UNIX_TIME2] << 16)
+		| ((uint32_t)reg[RV3028_UNIX_TIME1] << 8) | reg[RV3028_UNIX_TIME0];
+
+	RV3028_DateTime dateTime;
+	dateTime.seconds = BCDtoDEC(reg[RV3028_SECONDS]);
+	dateTime.minutes = BCDtoDEC(reg[RV3028_MINUTES]);
+	if (reg[RV3028_CTRL2] & 1 << CTRL2_12_24)
+	{
+		dateTime.hours = BCDtoDEC(reg[RV3028_HOURS] & ~(1 << HOURS_AM_PM)) % 12; //12AM is 0
+		if (reg[RV3028_HOURS] & 1 << HOURS_AM_PM) dateTime.hours += 12;
+	}
+	else
+		dateTime.hours = BCDtoDEC(reg[RV3028_HOURS]);
+	dateTime.date = BCDtoDEC(reg[RV3028_DATE]);
+	dateTime.month = BCDtoDEC(reg[RV3028_MONTHS]);
+	dateTime.year = BCDtoDEC(reg[RV3028_YEARS]) + 2000;
+	_telemetry.calendarOffset = (int32_t)(dateTimeToUNIX(dateTime) - *unixTime);
+
+	//Drift of the UNIX Time since resync(), a power on reset ends the measurement
+	if (_syncValid && reference - _syncReference >= TELEMETRY_MIN_DRIFT_SECONDS)
+	{
+		int32_t error = (int32_t)(*unixTime - reference);
+		float drift = (float)error * 1.0e7 / (reference - _syncReference);
+		int16_t drift16 = constrain(drift, -32768.0, 32767.0);
+
+		if (_telemetry.driftSamples == 0 || drift16 < _telemetry.driftMin) _telemetry.driftMin = drift16;
+		if (_telemetry.driftSamples == 0 || drift16 > _telemetry.driftMax) _telemetry.driftMax = drift16;
+		_telemetry.driftLast = drift16;
+		_telemetry.driftSamples++;
+	}
+	return true;
+}
+
+//Counts every PORF and BSF once, also if the flag is read several times before it is cleared
+void RV3028::noteStatus(uint8_t status)
+{
+	uint8_t newFlags = status & ~_statusSeen;
+	if (newFlags & 1 << STATUS_PORF)
+	{
+		_telemetry.powerOnResets++;
+		_syncValid = false; //Time was lost
+	}
+	if (newFlags & 1 << STATUS_BSF) _telemetry.switchovers++;
+	_statusSeen = status;
+}
+
 /*********************************
 Enable the Trickle Charger and set the Trickle Charge series resistor (default is 11k)
 TCR_1K  =  1kOhm
@@ -485,6 +1185,8 @@ TCR_11K = 11kOhm
 *********************************/
 void RV3028::enableTrickleCharge(uint8_t tcr)
 {
+	LockGuard guard(this);
+
 	if (tcr > 3) return;
 
 	//Read EEPROM Backup Register (0x37)
@@ -500,6 +1202,8 @@ void RV3028::enableTrickleCharge(uint8_t tcr)
 
 void RV3028::disableTrickleCharge()
 {
+	LockGuard guard(this);
+
 	//Read EEPROM Backup Register (0x37)
 	uint8_t EEPROMBackup = readConfigEEPROM_RAMmirror(EEPROM_Backup_Register);
 	//Write 0 to TCE Bit
@@ -516,6 +1220,8 @@ void RV3028::disableTrickleCharge()
 *********************************/
 bool RV3028::setBackupSwitchoverMode(uint8_t val)
 {
+	LockGuard guard(this);
+
 	if (val > 3)return false;
 	bool success = true;
 
@@ -558,52 +1264,117 @@ uint8_t RV3028::DECtoBCD(uint8_t val)
 
 uint8_t RV3028::readRegister(uint8_t addr)
 {
+	LockGuard guard(this);
+
+	uint8_t batchValue;
+	if (batchRead(addr, &batchValue)) return batchValue; //Recorded in the current write batch
+
 	_i2cPort->beginTransmission(RV3028_ADDR);
 	_i2cPort->write(addr);
-	_i2cPort->endTransmission();
+	if (_i2cPort->endTransmission() != 0)
+	{
+		_telemetry.busErrors++;
+		return (0xFF); //Error: Sensor did not ack
+	}
 
 	_i2cPort->requestFrom(RV3028_ADDR, (uint8_t)1);
 	if (_i2cPort->available()) {
 		uint8_t zws = _i2cPort->read();
 
+		if (addr == RV3028_CTRL1 && _batchDepth > 0)
+		{
+			_batchCtrl1 = zws;
+			_batchCtrl1Known = true;
+		}
+
 		//clear status register when it was read
-		if (addr == RV3028_STATUS) writeRegister(addr, 0);
+		if (addr == RV3028_STATUS)
+		{
+			noteStatus(zws);
+			writeRegister(addr, 0);
+		}
 
 		return zws;
 	}
 	else {
+		_telemetry.busErrors++;
 		return (0xFF); //Error
 	}
 }
 
 bool RV3028::writeRegister(uint8_t addr, uint8_t val)
 {
+	LockGuard guard(this);
+
+	if (_batchDepth > 0 && batchWrite(addr, val)) return(true);
+
 	_i2cPort->beginTransmission(RV3028_ADDR);
 	_i2cPort->write(addr);
 	_i2cPort->write(val);
 	if (_i2cPort->endTransmission() != 0)
+	{
+		_telemetry.busErrors++;
 		return (false); //Error: Sensor did not ack
+	}
+	if (addr == RV3028_STATUS) _statusSeen &= val; //Flags written with 0 are cleared
 	return(true);
 }
 
 bool RV3028::readMultipleRegisters(uint8_t addr, uint8_t * dest, uint8_t len)
 {
+	LockGuard guard(this);
+
+	if (_batchCount > 0) flushBatch(); //Read the recorded values back from the RTC
+
+	//Split long reads into bursts that fit into the Wire buffer
+	while (len > RV3028_BURST_LENGTH)
+	{
+		if (readMultipleRegisters(addr, dest, RV3028_BURST_LENGTH) == false)
+			return (false);
+		addr += RV3028_BURST_LENGTH;
+		dest += RV3028_BURST_LENGTH;
+		len -= RV3028_BURST_LENGTH;
+	}
+
 	_i2cPort->beginTransmission(RV3028_ADDR);
 	_i2cPort->write(addr);
 	if (_i2cPort->endTransmission() != 0)
+	{
+		_telemetry.busErrors++;
 		return (false); //Error: Sensor did not ack
+	}
 
-	_i2cPort->requestFrom(RV3028_ADDR, len);
+	if (_i2cPort->requestFrom(RV3028_ADDR, len) != len)
+	{
+		_telemetry.busErrors++;
+		return (false); //Error: Short read
+	}
 	for (uint8_t i = 0; i < len; i++)
 	{
 		dest[i] = _i2cPort->read();
 	}
 
+	if (addr <= RV3028_STATUS && addr + len > RV3028_STATUS) noteStatus(dest[RV3028_STATUS - addr]);
+
 	return(true);
 }
 
 bool RV3028::writeMultipleRegisters(uint8_t addr, uint8_t * values, uint8_t len)
 {
+	LockGuard guard(this);
+
+	if (_batchCount > 0) flushBatch(); //Keep the order of recorded writes and bursts
+
+	//Split long writes into bursts that fit into the Wire buffer
+	while (len > RV3028_BURST_LENGTH)
+	{
+		if (writeMultipleRegisters(addr, values, RV3028_BURST_LENGTH) == false)
+			return (false);
+		addr += RV3028_BURST_LENGTH;
+		values += RV3028_BURST_LENGTH;
+		len -= RV3028_BURST_LENGTH;
+	}
+
 	_i2cPort->beginTransmission(RV3028_ADDR);
 	_i2cPort->write(addr);
 	for (uint8_t i = 0; i < len; i++)
@@ -612,12 +1383,26 @@ bool RV3028::writeMultipleRegisters(uint8_t addr, uint8_t * values, uint8_t len)
 	}
 
 	if (_i2cPort->endTransmission() != 0)
+	{
+		_telemetry.busErrors++;
 		return (false); //Error: Sensor did not ack
+	}
+	if (addr <= RV3028_STATUS && addr + len > RV3028_STATUS) _statusSeen &= values[RV3028_STATUS - addr];
+	if (addr <= RV3028_CTRL1 && addr + len > RV3028_CTRL1) _batchCtrl1 = values[RV3028_CTRL1 - addr];
 	return(true);
 }
 
 bool RV3028::writeConfigEEPROM_RAMmirror(uint8_t eepromaddr, uint8_t val)
 {
+	LockGuard guard(this);
+
+	if (_batchDepth > 0)
+	{
+		//Stored in the EEPROM by endWriteBatch()
+		_batchEEPROMUpdate = true;
+		return batchWrite(eepromaddr, val);
+	}
+
 	bool success = waitforEEPROM();
 
 	//Disable auto refresh by writing 1 to EERD control bit in CTRL1 register
@@ -642,6 +1427,11 @@ bool RV3028::writeConfigEEPROM_RAMmirror(uint8_t eepromaddr, uint8_t val)
 
 uint8_t RV3028::readConfigEEPROM_RAMmirror(uint8_t eepromaddr)
 {
+	LockGuard guard(this);
+
+	uint8_t batchValue;
+	if (batchRead(eepromaddr, &batchValue)) return batchValue; //Not yet stored in the EEPROM
+
 	bool success = waitforEEPROM();
 
 	//Disable auto refresh by writing 1 to EERD control bit in CTRL1 register
@@ -668,8 +1458,360 @@ uint8_t RV3028::readConfigEEPROM_RAMmirror(uint8_t eepromaddr)
 //True if success, false if timeout occured
 bool RV3028::waitforEEPROM()
 {
-	unsigned long timeout = millis() + 500;
-	while ((readRegister(RV3028_STATUS) & 1 << STATUS_EEBUSY) && millis() < timeout);
+	LockGuard guard(this);
+
+	//A burst read does not clear the interrupt flags like readRegister(RV3028_STATUS), service() still sees them
+	unsigned long start = millis();
+	unsigned long timeout = start + 500;
+	uint8_t status;
+	do
+	{
+		if (readMultipleRegisters(RV3028_STATUS, &status, 1) == false) status = 0xFF; //Busy until the timeout
+	} while ((status & 1 << STATUS_EEBUSY) && millis() < timeout);
+
+	unsigned long end = millis();
+	_telemetry.eepromBusyMillis += end - start;
+	if (end >= timeout)
+	{
+		_telemetry.eepromTimeouts++;
+		return false;
+	}
+	return true;
+}
+
+/*********************************
+Write batch: Between beginWriteBatch() and endWriteBatch() register writes are recorded instead of sent.
+Repeated writes to the same register are folded into one and reading a recorded register returns the
+recorded value without bus access. endWriteBatch() sends the registers in ascending address order with
+one burst per run of adjacent addresses. All changes made by writeConfigEEPROM_RAMmirror() are stored
+with a single EEPROM Update.
+Writes to CTRL2, the password and the EEPROM control registers and CTRL1 writes that start or stop
+the countdown timer keep their order: the batch is sent before them (e.g. TE=0, Timer Value, TE=1). STATUS is always written immediately. Burst reads and writes send the batch first.
+If a lock is set, it is held from beginWriteBatch() to endWriteBatch().
+*********************************/
+void RV3028::beginWriteBatch()
+{
+	if (_lock != NULL) _lock(_lockContext);
+
+	if (_batchDepth++ > 0) return; //Nested batch
+	_batchCount = 0;
+	_batchEEPROMUpdate = false;
+	_batchSuccess = true;
+	_batchCtrl1Known = false;
+}
+
+bool RV3028::endWriteBatch()
+{
+	if (_batchDepth == 0) return false;
+
+	bool success = true;
+	if (_batchDepth == 1)
+	{
+		if (_batchEEPROMUpdate)
+		{
+			//Disable auto refresh by writing 1 to EERD control bit in CTRL1 register
+			//CTRL1 has a lower address than the configuration RAM, so it is sent first
+			if (!waitforEEPROM()) success = false;
+			uint8_t ctrl1 = readRegister(RV3028_CTRL1);
+			batchWrite(RV3028_CTRL1, ctrl1 | 1 << CTRL1_EERD);
+			flushBatch();
+			_batchDepth = 0; //Send the EEPROM commands immediately
+
+			//Update EEPROM (All Configuration RAM -> EEPROM)
+			writeRegister(RV3028_EEPROM_CMD, EEPROMCMD_First);
+			writeRegister(RV3028_EEPROM_CMD, EEPROMCMD_Update);
+			if (!waitforEEPROM()) success = false;
+			//Reenable auto refresh by writing 0 to EERD control bit in CTRL1 register
+			if (!writeRegister(RV3028_CTRL1, ctrl1 & ~(1 << CTRL1_EERD))) success = false;
+			if (!waitforEEPROM()) success = false;
+		}
+		else
+			flushBatch();
+
+		if (!_batchSuccess) success = false;
+		_batchDepth = 0;
+	}
+	else
+		_batchDepth--;
+
+	if (_unlock != NULL) _unlock(_lockContext);
+	return success;
+}
+
+//Records a write, returns false if the register has to be written immediately (after sending the batch)
+bool RV3028::batchWrite(uint8_t addr, uint8_t val)
+{
+	if (addr == RV3028_STATUS)
+		return false;
+	if (addr == RV3028_CTRL2 || (addr >= RV3028_PASSWORD0 && addr <= RV3028_EEPROM_CMD))
+	{
+		flushBatch();
+		return false;
+	}
+	if (addr == RV3028_CTRL1)
+	{
+		//The Timer Value may only be changed while the timer is stopped
+		if (_batchCtrl1Known == false) _batchCtrl1 = readRegister(RV3028_CTRL1);
+		bool timerChange = (val ^ _batchCtrl1) & 1 << CTRL1_TE;
+		_batchCtrl1 = val;
+		_batchCtrl1Known = true;
+		if (timerChange)
+		{
+			flushBatch();
+			return false;
+		}
+	}
+
+	for (uint8_t i = 0; i < _batchCount; i++)
+	{
+		if (_batchAddr[i] == addr)
+		{
+			_batchValue[i] = val; //Fold into the recorded write
+			return true;
+		}
+	}
+
+	if (_batchCount == WRITE_BATCH_LENGTH) flushBatch();
+	_batchAddr[_batchCount] = addr;
+	_batchValue[_batchCount] = val;
+	_batchCount++;
+	return true;
+}
+
+//True if addr was written in the current batch
+bool RV3028::batchRead(uint8_t addr, uint8_t * val)
+{
+	for (uint8_t i = 0; i < _batchCount; i++)
+	{
+		if (_batchAddr[i] == addr)
+		{
+			*val = _batchValue[i];
+			return true;
+		}
+	}
+	return false;
+}
+
+//Sends the recorded writes in ascending address order, one burst per run of adjacent addresses
+bool RV3028::flushBatch()
+{
+	uint8_t count = _batchCount;
+	_batchCount = 0; //writeMultipleRegisters() must not send the batch again
+
+	//Insertion sort by address
+	for (uint8_t i = 1; i < count; i++)
+	{
+		uint8_t addr = _batchAddr[i];
+		uint8_t value = _batchValue[i];
+		uint8_t j = i;
+		for (; j > 0 && _batchAddr[j - 1] > addr; j--)
+		{
+			_batchAddr[j] = _batchAddr[j - 1];
+			_batchValue[j] = _batchValue[j - 1];
+		}
+		_batchAddr[j] = addr;
+		_batchValue[j] = value;
+	}
+
+	bool success = true;
+	uint8_t first = 0;
+	while (first < count)
+	{
+		uint8_t last = first + 1;
+		while (last < count && _batchAddr[last] == _batchAddr[last - 1] + 1) last++;
+		if (!writeMultipleRegisters(_batchAddr[first], &_batchValue[first], last - first)) success = false;
+		first = last;
+	}
+
+	if (!success) _batchSuccess = false;
+	return success;
+}
+
+//Registers written back by restoreImage()
+//Time, status, timestamp, UNIX time, password, EEPROM control and ID registers are left untouched
+static const uint8_t imageRestoreRanges[][2] = {
+	{ RV3028_MINUTES_ALM, RV3028_TIMERVAL_1 },	//Alarm and countdown timer value
+	{ RV3028_CTRL1, RV3028_EVENTCTRL },			//Control, GP bits, clock interrupt mask and event control
+	{ RV3028_USER_RAM1, RV3028_USER_RAM2 },		//User RAM
+};
+
+/*********************************
+Read an image of the RTC for provisioning of other units with restoreImage()
+The image holds registers 0x00 to 0x28, the configuration RAM mirror 0x30 to 0x37
+and the user EEPROM 0x00 to 0x2A, protected by a CRC
+*********************************/
+bool RV3028::dumpImage(RV3028_Image &image)
+{
+	LockGuard guard(this);
+
+	image.version = RV3028_IMAGE_VERSION;
+	image.reserved = 0;
+
+	bool success = readMultipleRegisters(RV3028_SECONDS, image.registers, IMAGE_REGISTERS_LENGTH);
+	if (!readMultipleRegisters(EEPROM_Config_First, image.configEEPROM, IMAGE_CONFIG_LENGTH)) success = false;
+
+	//User EEPROM can only be read byte by byte, auto refresh is disabled once for all bytes
+	if (!waitforEEPROM()) success = false;
+	uint8_t ctrl1 = readRegister(RV3028_CTRL1);
+	if (!writeRegister(RV3028_CTRL1, ctrl1 | 1 << CTRL1_EERD)) success = false;
+	for (uint8_t i = 0; i < IMAGE_USER_EEPROM_LENGTH; i++)
+	{
+		if (!readEEPROMSingle(EEPROM_User_First + i, &image.userEEPROM[i])) success = false;
+	}
+	//Reenable auto refresh by writing 0 to EERD control bit in CTRL1 register
+	writeRegister(RV3028_CTRL1, ctrl1 & ~(1 << CTRL1_EERD));
 
-	return millis() < timeout;
+	image.crc = imageCRC(image);
+	return success;
+}
+
+/*********************************
+Write an image taken with dumpImage() to the RTC
+Only bytes that differ from the image are written. All changes of the configuration
+RAM mirror are stored with a single EEPROM Update, user EEPROM bytes are written one by one.
+Returns false without writing anything if the version or the CRC of the image does not match
+*********************************/
+bool RV3028::restoreImage(const RV3028_Image &image)
+{
+	LockGuard guard(this);
+
+	if (image.version != RV3028_IMAGE_VERSION || image.crc != imageCRC(image))
+		return false;
+
+	uint8_t current[IMAGE_REGISTERS_LENGTH];
+	if (!readMultipleRegisters(RV3028_SECONDS, current, IMAGE_REGISTERS_LENGTH))
+		return false;
+
+	uint8_t target[IMAGE_REGISTERS_LENGTH];
+	memcpy(target, image.registers, IMAGE_REGISTERS_LENGTH);
+	target[RV3028_CTRL1] &= ~(1 << CTRL1_EERD);		//Auto refresh is handled below
+	target[RV3028_CTRL2] &= ~(1 << CTRL2_RESET);	//Never restore a reset
+
+	//The time registers are not restored, so the unit keeps its 12/24 hour mode and the alarm hour is converted to it
+	bool image12Hour = target[RV3028_CTRL2] & 1 << CTRL2_12_24;
+	bool unit12Hour = current[RV3028_CTRL2] & 1 << CTRL2_12_24;
+	target[RV3028_CTRL2] = (target[RV3028_CTRL2] & ~(1 << CTRL2_12_24)) | (current[RV3028_CTRL2] & 1 << CTRL2_12_24);
+	if (image12Hour != unit12Hour)
+	{
+		uint8_t alarmEnable = target[RV3028_HOURS_ALM] & 1 << HOURSALM_AE_H;
+		uint8_t hour;
+		if (image12Hour)
+		{
+			hour = BCDtoDEC(target[RV3028_HOURS_ALM] & 0x1F) % 12; //12AM is 0
+			if (target[RV3028_HOURS_ALM] & 1 << HOURS_AM_PM) hour += 12;
+			hour = DECtoBCD(hour);
+		}
+		else
+		{
+			hour = BCDtoDEC(target[RV3028_HOURS_ALM] & 0x3F);
+			bool pm = hour >= 12;
+			hour %= 12;
+			if (hour == 0) hour = 12;
+			hour = DECtoBCD(hour);
+			if (pm) hour |= 1 << HOURS_AM_PM;
+		}
+		target[RV3028_HOURS_ALM] = hour | alarmEnable;
+	}
+
+	bool success = true;
+	for (uint8_t i = 0; i < sizeof(imageRestoreRanges) / sizeof(imageRestoreRanges[0]); i++)
+	{
+		uint8_t first = imageRestoreRanges[i][0];
+		uint8_t len = imageRestoreRanges[i][1] - first + 1;
+		if (!writeChangedRegisters(first, current + first, target + first, len)) success = false;
+	}
+
+	//Disable auto refresh by writing 1 to EERD control bit in CTRL1 register
+	if (!waitforEEPROM()) success = false;
+	uint8_t ctrl1 = readRegister(RV3028_CTRL1);
+	if (!writeRegister(RV3028_CTRL1, ctrl1 | 1 << CTRL1_EERD)) success = false;
+
+	//Configuration RAM mirror, one Update stores all changes in the EEPROM
+	uint8_t config[IMAGE_CONFIG_LENGTH];
+	if (!readMultipleRegisters(EEPROM_Config_First, config, IMAGE_CONFIG_LENGTH)) success = false;
+	if (memcmp(config, image.configEEPROM, IMAGE_CONFIG_LENGTH) != 0)
+	{
+		if (!writeChangedRegisters(EEPROM_Config_First, config, image.configEEPROM, IMAGE_CONFIG_LENGTH)) success = false;
+		writeRegister(RV3028_EEPROM_CMD, EEPROMCMD_First);
+		writeRegister(RV3028_EEPROM_CMD, EEPROMCMD_Update);
+		if (!waitforEEPROM()) success = false;
+	}
+
+	//User EEPROM
+	for (uint8_t i = 0; i < IMAGE_USER_EEPROM_LENGTH; i++)
+	{
+		uint8_t value;
+		if (!readEEPROMSingle(EEPROM_User_First + i, &value))
+			success = false;
+		else if (value != image.userEEPROM[i] && !writeEEPROMSingle(EEPROM_User_First + i, image.userEEPROM[i]))
+			success = false;
+	}
+
+	//Reenable auto refresh by writing 0 to EERD control bit in CTRL1 register
+	writeRegister(RV3028_CTRL1, ctrl1 & ~(1 << CTRL1_EERD));
+
+	return success;
+}
+
+//CRC-16/CCITT (polynomial 0x1021, start value 0xFFFF) of the image without the crc field
+uint16_t RV3028::imageCRC(const RV3028_Image &image)
+{
+	const uint8_t * data = (const uint8_t *)&image;
+	uint16_t crc = 0xFFFF;
+
+	for (uint8_t i = 0; i < sizeof(RV3028_Image); i++)
+	{
+		if (i >= offsetof(RV3028_Image, crc) && i < offsetof(RV3028_Image, registers))
+			continue;
+
+		crc ^= (uint16_t)data[i] << 8;
+		for (uint8_t bit = 0; bit < 8; bit++)
+			crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+	}
+	return crc;
+}
+
+//Read a single EEPROM byte, auto refresh (EERD) has to be disabled by the caller
+bool RV3028::readEEPROMSingle(uint8_t eepromaddr, uint8_t * val)
+{
+	//EEPROM_ADDR, EEPROM_DATA and EEPROM_CMD are written in one burst
+	uint8_t command[3] = { eepromaddr, 0x00, EEPROMCMD_First };
+	bool success = writeMultipleRegisters(RV3028_EEPROM_ADDR, command, 3);
+	if (!writeRegister(RV3028_EEPROM_CMD, EEPROMCMD_ReadSingle)) success = false;
+	if (!waitforEEPROM()) success = false;
+	*val = readRegister(RV3028_EEPROM_DATA);
+
+	return success;
+}
+
+//Write a single EEPROM byte, auto refresh (EERD) has to be disabled by the caller
+bool RV3028::writeEEPROMSingle(uint8_t eepromaddr, uint8_t val)
+{
+	uint8_t command[3] = { eepromaddr, val, EEPROMCMD_First };
+	bool success = writeMultipleRegisters(RV3028_EEPROM_ADDR, command, 3);
+	if (!writeRegister(RV3028_EEPROM_CMD, EEPROMCMD_WriteSingle)) success = false;
+	if (!waitforEEPROM()) success = false;
+
+	return success;
+}
+
+//Write the runs of registers where values differs from current, one burst per run
+bool RV3028::writeChangedRegisters(uint8_t addr, const uint8_t * current, const uint8_t * values, uint8_t len)
+{
+	bool success = true;
+	uint8_t i = 0;
+
+	while (i < len)
+	{
+		if (current[i] == values[i])
+		{
+			i++;
+			continue;
+		}
+
+		uint8_t first = i;
+		while (i < len && current[i] != values[i]) i++;
+		if (!writeMultipleRegisters(addr + first, (uint8_t *)values + first, i - first)) success = false;
+	}
+	return success;
 }
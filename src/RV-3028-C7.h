@@ -97,6 +97,10 @@ Distributed as-is; no warranty is given.
 #define RV3028_ID						0x28
 
 //EEPROM Registers
+#define EEPROM_User_First				0x00			//User EEPROM 0x00 to 0x2A
+#define EEPROM_User_Last				0x2A
+#define EEPROM_Config_First				0x30			//Configuration EEPROM with RAM mirror 0x30 to 0x37
+#define EEPROM_Config_Last				0x37
 #define EEPROM_Clkout_Register			0x35
 #define EEPROM_Backup_Register			0x37
 
@@ -132,6 +136,13 @@ Distributed as-is; no warranty is given.
 #define CTRL2_12_24		1
 #define CTRL2_RESET		0
 
+//Bits in Event Control Register
+#define EVENTCTRL_EHL		6
+#define EVENTCTRL_ET		4	//2 bits, event filtering time
+#define EVENTCTRL_TSR		2
+#define EVENTCTRL_TSOW		1
+#define EVENTCTRL_TSS		0
+
 //Bits in Hours register
 #define HOURS_AM_PM			5
 
@@ -160,9 +171,95 @@ Distributed as-is; no warranty is given.
 #define	TCR_6K							0b10			//Trickle Charge Resistor 6kOhm
 #define	TCR_11K							0b11			//Trickle Charge Resistor 11kOhm
 
+//Event filtering time of EVI (see enablePulseCounter())
+#define	EVENT_FILTER_OFF				0b00			//No filtering
+#define	EVENT_FILTER_3_9MS				0b01			//3.9ms
+#define	EVENT_FILTER_15_6MS				0b10			//15.6ms
+#define	EVENT_FILTER_125MS				0b11			//125ms
+
 
 #define TIME_ARRAY_LENGTH 7 // Total number of writable values in device
 
+//Buffer sizes for the string functions
+#define STRING_DATE_LENGTH		11 // stringDateUSA(), stringDate() and stringTime()
+#define STRING_TIMESTAMP_LENGTH	25 // stringTimeStamp()
+
+//Date and time in decimal, 24 hour format (see dateTimeToUNIX() and UNIXtoDateTime())
+struct RV3028_DateTime
+{
+	uint8_t seconds;
+	uint8_t minutes;
+	uint8_t hours;		//0 to 23
+	uint8_t weekday;	//0 (Sunday) to 6 (Saturday)
+	uint8_t date;
+	uint8_t month;
+	uint16_t year;
+};
+
+//Alarm configuration (see setAlarm() and getAlarm())
+struct RV3028_Alarm
+{
+	uint8_t minutes;
+	uint8_t hours;				//0 to 23, also if the RTC is in 12 hour mode
+	uint8_t date_or_weekday;
+	bool weekdayAlarm;			//true: date_or_weekday is a weekday from 0 (Sunday) to 6 (Saturday)
+	uint8_t mode;				//0 to 7, see enableAlarmInterrupt()
+	bool interrupt;				//Alarm interrupt enabled
+};
+
+//Health counters and time quality (see getTelemetry()), 28 bytes to send with every uplink
+struct RV3028_Telemetry
+{
+	uint32_t eepromBusyMillis;	//Time waited for the EEPROM
+	int32_t calendarOffset;		//Real time minus UNIX Time in seconds at the last updateTelemetry()
+	uint16_t powerOnResets;		//PORF seen in the status register
+	uint16_t switchovers;		//BSF seen in the status register
+	uint16_t busErrors;			//Missing acknowledge or short read
+	uint16_t eepromTimeouts;	//waitforEEPROM() gave up
+	uint16_t resyncs;
+	int16_t lastCorrection;		//Seconds added to the UNIX Time by the last resync(), negative if the RTC was fast
+	uint16_t driftSamples;		//Drift measurements, driftMin and driftMax are valid if > 0
+	int16_t driftLast;			//Drift since the last resync() in 0.1 ppm, positive if the RTC is fast
+	int16_t driftMin;
+	int16_t driftMax;
+};
+
+//Shortest time since resync() for a drift measurement, the resolution is 1 s per interval (11.6 ppm per day)
+#define TELEMETRY_MIN_DRIFT_SECONDS 86400UL
+
+//Written to USER_RAM1 and USER_RAM2 by begin() with warm start, change it when begin() configures the RTC differently
+#define RV3028_WARMSTART_FINGERPRINT_1	0x30
+#define RV3028_WARMSTART_FINGERPRINT_2	0x28
+
+//Orders memory accesses between ISR, tasks and cores (compiler barrier on single core AVR)
+#if defined(__AVR__)
+#define RV3028_MEMORY_BARRIER()	__asm__ __volatile__("" ::: "memory")
+#else
+#define RV3028_MEMORY_BARRIER()	__sync_synchronize()
+#endif
+
+//Max bytes per I2C transfer, the Wire buffer of AVR boards holds 32 bytes including the register address
+#define RV3028_BURST_LENGTH 31
+
+//Register writes recorded between beginWriteBatch() and endWriteBatch() before they are sent
+#define WRITE_BATCH_LENGTH 16
+
+//Register and EEPROM image (see dumpImage() and restoreImage())
+#define RV3028_IMAGE_VERSION			1
+#define IMAGE_REGISTERS_LENGTH			(RV3028_ID + 1)
+#define IMAGE_CONFIG_LENGTH				(EEPROM_Config_Last - EEPROM_Config_First + 1)
+#define IMAGE_USER_EEPROM_LENGTH		(EEPROM_User_Last - EEPROM_User_First + 1)
+
+struct RV3028_Image
+{
+	uint8_t version;								//RV3028_IMAGE_VERSION
+	uint8_t reserved;								//Keeps the layout free of padding on all architectures
+	uint16_t crc;									//CRC-16/CCITT of all other bytes of the image
+	uint8_t registers[IMAGE_REGISTERS_LENGTH];		//Registers 0x00 to 0x28
+	uint8_t configEEPROM[IMAGE_CONFIG_LENGTH];		//Configuration RAM mirror 0x30 to 0x37
+	uint8_t userEEPROM[IMAGE_USER_EEPROM_LENGTH];	//User EEPROM 0x00 to 0x2A
+};
+
 enum time_order {		
 	TIME_SECONDS,    // 0
 	TIME_MINUTES,    // 1
@@ -179,7 +276,11 @@ public:
 
 	RV3028(void);
 
-	boolean begin(TwoWire &wirePort = Wire);
+	boolean begin(TwoWire &wirePort = Wire, bool warmStart = false);
+	uint8_t bootStatus(); //Returns the status byte as it was before begin()
+	void setLock(void (*lock)(void * context), void (*unlock)(void * context), void * context = NULL); //Recursive lock for use from several tasks
+	void lock(); //Take the lock set with setLock(), e.g. around a read-modify-write sequence of several calls
+	void unlock();
 
 	bool setTime(uint8_t sec, uint8_t min, uint8_t hour, uint8_t weekday, uint8_t date, uint8_t month, uint16_t year);
 	bool setTime(uint8_t * time, uint8_t len);
@@ -198,6 +299,12 @@ public:
 	char* stringDate(); //Return date in dd-mm-yyyy
 	char* stringTime(); //Return time hh:mm:ss with AM/PM if in 12 hour mode
 	char* stringTimeStamp(); //Return timeStamp in ISO 8601 format yyyy-mm-ddThh:mm:ss
+	//Same as above, but written into buffer instead of a static array
+	char* stringDateUSA(char * buffer);
+	char* stringDate(char * buffer);
+	char* stringTime(char * buffer);
+	char* stringTimeStamp(char * buffer);
+	RV3028_DateTime getDateTime(); //Return time read by updateTime() in 24 hour format
 
 	uint8_t getSeconds();
 	uint8_t getMinutes();
@@ -209,17 +316,40 @@ public:
 
 
 	bool is12Hour(); //Returns true if 12hour bit is set
-	bool isPM(); //Returns true if is12Hour and PM bit is set
+	bool isPM(); //Returns true if the time read by updateTime() is in 12 hour format and PM
 	void set12Hour();
 	void set24Hour();
+	void enableSoftwareHourMode(); //Keep the RTC in 24 hour mode, 12 hour format only in the getters and strings
+	void disableSoftwareHourMode();
 
 	bool setUNIX(uint32_t value);//Set the UNIX Time (Real Time and UNIX Time are INDEPENDENT!)
 	uint32_t getUNIX();
 
+	//Calculate seconds since 1970-01-01 from date and time and back, no bus access
+	static uint32_t dateTimeToUNIX(const RV3028_DateTime &dateTime);
+	static RV3028_DateTime UNIXtoDateTime(uint32_t value);
+	static int32_t daysFromDate(uint16_t year, uint8_t month, uint8_t date); //Days since 1970-01-01
+	static uint8_t weekdayFromDate(uint16_t year, uint8_t month, uint8_t date); //0 (Sunday) to 6 (Saturday)
+
 	void enableAlarmInterrupt(uint8_t min, uint8_t hour, uint8_t date_or_weekday, bool setWeekdayAlarm_not_Date, uint8_t mode);
 	void enableAlarmInterrupt();
 	void disableAlarmInterrupt();
 	bool readAlarmInterruptFlag();
+	bool setAlarm(const RV3028_Alarm &alarm); //Writes only if the alarm differs from the one in the RTC
+	bool getAlarm(RV3028_Alarm &alarm);
+
+	bool enablePulseCounter(bool risingEdge = true, uint8_t filter = EVENT_FILTER_3_9MS); //Count events on EVI
+	void disablePulseCounter();
+	void resetPulseCounter();
+	bool updatePulseCounter(); //Read counter and time of the last event in one burst
+	uint32_t getPulseCount(); //Pulses since enablePulseCounter() or resetPulseCounter()
+	uint32_t getPulseTime(); //Time of the last pulse in seconds since 1970-01-01
+	float getPulseRate(); //Pulses per second
+
+	bool updateTelemetry(uint32_t reference); //Compare with a reference UNIX Time, e.g. from NTP or GPS
+	bool resync(uint32_t reference); //Set real time and UNIX Time to the reference and start a new drift measurement
+	RV3028_Telemetry getTelemetry();
+	void resetTelemetry();
 
 	void enableTrickleCharge(uint8_t tcr = TCR_11K); //Trickle Charge Resistor default 11k
 	void disableTrickleCharge();
@@ -242,9 +372,57 @@ public:
 	uint8_t readConfigEEPROM_RAMmirror(uint8_t eepromaddr);
 	bool waitforEEPROM();
 
+	void beginWriteBatch(); //Record register writes instead of sending them
+	bool endWriteBatch(); //Send the recorded writes combined into bursts
+
+	bool dumpImage(RV3028_Image &image); //Read registers, configuration and user EEPROM into image
+	bool restoreImage(const RV3028_Image &image); //Write only the bytes that differ from image
+	static uint16_t imageCRC(const RV3028_Image &image);
+
 private:	
 	uint8_t _time[TIME_ARRAY_LENGTH];
+	uint8_t _timeFlags; //12 hour mode and PM of _time
+	volatile uint8_t _timeSequence; //Odd while _time is written
+	uint8_t _bootStatus;
+	bool _softwareHourMode; //RTC stays in 24 hour mode
+	bool _softwareHour12; //12 hour format in software hour mode
+	uint32_t _pulseCount; //Count TS register extended to 32 bit
+	uint8_t _pulseCountTS; //Count TS register at the last updatePulseCounter()
+	uint32_t _pulseTime;
+	float _pulseRate;
+	RV3028_Telemetry _telemetry;
+	uint8_t _statusSeen; //Flags of the last status register read, to count every flag once
+	bool _syncValid; //Drift reference of the last resync()
+	uint32_t _syncReference;
 	TwoWire *_i2cPort;
+	void (*_lock)(void * context);
+	void (*_unlock)(void * context);
+	void * _lockContext;
+
+	struct LockGuard;
+	void readTimeSnapshot(uint8_t * time, uint8_t * flags);
+	void writeTimeSnapshot(const uint8_t * time, uint8_t flags);
+	bool setTimeField(uint8_t field, uint8_t value);
+	uint8_t displayHours(const uint8_t * time, uint8_t flags, char * half);
+	bool hardware12Hour(); //Reads the 12/24 hour bit of the RTC
+
+	uint8_t _batchDepth; //Nesting of beginWriteBatch()
+	uint8_t _batchCount;
+	uint8_t _batchAddr[WRITE_BATCH_LENGTH];
+	uint8_t _batchValue[WRITE_BATCH_LENGTH];
+	bool _batchEEPROMUpdate; //Configuration RAM mirror changed in the batch
+	bool _batchSuccess;
+	uint8_t _batchCtrl1; //Last CTRL1 value read or written in the batch
+	bool _batchCtrl1Known;
+
+	bool batchWrite(uint8_t addr, uint8_t val);
+	bool batchRead(uint8_t addr, uint8_t * val);
+	bool flushBatch();
+	void noteStatus(uint8_t status);
+	bool measureTime(uint32_t reference, uint32_t * unixTime);
+	bool readEEPROMSingle(uint8_t eepromaddr, uint8_t * val);
+	bool writeEEPROMSingle(uint8_t eepromaddr, uint8_t val);
+	bool writeChangedRegisters(uint8_t addr, const uint8_t * current, const uint8_t * values, uint8_t len);
 };
 
 //POSSIBLE ENHANCEMENTS :
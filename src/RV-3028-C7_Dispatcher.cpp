@@ -0,0 +1,123 @@
+/******************************************************************************
+RV-3028-C7_Dispatcher.cpp
+RV-3028-C7 Arduino Library
+https://github.com/constiko/RV-3028_C7-Arduino_Library
+
+Development environment specifics:
+Arduino IDE 1.8.9
+
+This code is released under the [MIT License](http://opensource.org/licenses/MIT).
+Please review the LICENSE.md file included with this example. If you have any questions
+or concerns with licensing, please contact constantinkoch@outlook.com.
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#include "RV-3028-C7_Dispatcher.h"
+
+RV3028_Dispatcher::RV3028_Dispatcher(RV3028 &rtc)
+{
+	_rtc = &rtc;
+	_pending = true; //Catch flags that were set before the ISR was attached
+	for (uint8_t i = 0; i < DISPATCHER_SOURCES; i++) _handlers[i] = NULL;
+	_head = 0;
+	_tail = 0;
+	_dropped = 0;
+}
+
+/*********************************
+Register a handler for an interrupt source, it is called by service() with the source
+STATUS_PORF = Power On Reset
+STATUS_EVF  = Event (EVI pin)
+STATUS_AF   = Alarm
+STATUS_TF   = Periodic Countdown Timer
+STATUS_UF   = Periodic Time Update
+STATUS_BSF  = Backup Switchover
+STATUS_CLKF = Clock Output
+*********************************/
+void RV3028_Dispatcher::attachHandler(uint8_t source, void (*handler)(uint8_t source))
+{
+	if (source >= DISPATCHER_SOURCES) return;
+	_handlers[source] = handler;
+}
+
+void RV3028_Dispatcher::detachHandler(uint8_t source)
+{
+	attachHandler(source, NULL);
+}
+
+/*********************************
+Call from loop() or a task, never from the ISR
+If an interrupt is pending, the status register is read and only the flags that were read are
+cleared (one read and one write), then the handlers are called and one event per source is queued.
+A flag set between the read and the write keeps INT low without a new falling edge, so the status
+register is read again until no flag is left (one more read). If flags keep coming for
+DISPATCHER_MAX_ROUNDS reads, the interrupt stays pending for the next call.
+Returns the flags that were handled, 0 if no interrupt was pending.
+*********************************/
+uint8_t RV3028_Dispatcher::service()
+{
+	if (_pending == false) return 0;
+	_pending = false; //Cleared before reading, an interrupt during service() is not lost
+
+	uint8_t handled = 0;
+	for (uint8_t round = 0; round < DISPATCHER_MAX_ROUNDS; round++)
+	{
+		//readMultipleRegisters() does not clear the status register like readRegister() does
+		uint8_t flags;
+		if (_rtc->readMultipleRegisters(RV3028_STATUS, &flags, 1) == false)
+		{
+			_pending = true;
+			return handled;
+		}
+		flags &= ~(1 << STATUS_EEBUSY);
+		if (flags == 0) return handled;
+
+		//Writing 1 to a flag has no effect, flags set after the read stay set for the next round
+		_rtc->writeRegister(RV3028_STATUS, ~flags);
+		dispatch(flags);
+		handled |= flags;
+	}
+
+	_pending = true;
+	return handled;
+}
+
+//Calls the handlers and queues one event per flag
+void RV3028_Dispatcher::dispatch(uint8_t flags)
+{
+	unsigned long now = millis();
+	for (uint8_t source = 0; source < DISPATCHER_SOURCES; source++)
+	{
+		if (!(flags & 1 << source)) continue;
+
+		if (_handlers[source] != NULL) _handlers[source](source);
+
+		uint8_t next = (_head + 1) & (DISPATCHER_QUEUE_LENGTH - 1);
+		if (next == _tail)
+		{
+			_dropped++;
+			continue;
+		}
+		_queue[_head].source = source;
+		_queue[_head].millis = now;
+		RV3028_MEMORY_BARRIER(); //Event is complete before it is published
+		_head = next;
+	}
+}
+
+bool RV3028_Dispatcher::readEvent(RV3028_Event &event)
+{
+	uint8_t tail = _tail;
+	if (tail == _head) return false;
+
+	RV3028_MEMORY_BARRIER(); //Read the event after it was published
+	event = _queue[tail];
+	RV3028_MEMORY_BARRIER(); //Event is copied before the slot is released
+	_tail = (tail + 1) & (DISPATCHER_QUEUE_LENGTH - 1);
+	return true;
+}
+
+uint16_t RV3028_Dispatcher::droppedEvents()
+{
+	return _dropped;
+}
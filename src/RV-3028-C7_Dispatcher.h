@@ -0,0 +1,63 @@
+/******************************************************************************
+RV-3028-C7_Dispatcher.h
+RV-3028-C7 Arduino Library
+https://github.com/constiko/RV-3028_C7-Arduino_Library
+
+Interrupt dispatcher for the INT pin of the RV-3028-C7.
+The ISR only sets a pending flag. service() reads and clears the status register until no flag
+is left, calls the handler of every interrupt source and queues one event per source for the application.
+
+Development environment specifics:
+Arduino IDE 1.8.9
+
+This code is released under the [MIT License](http://opensource.org/licenses/MIT).
+Please review the LICENSE.md file included with this example. If you have any questions
+or concerns with licensing, please contact constantinkoch@outlook.com.
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#pragma once
+
+#include "RV-3028-C7.h"
+
+#define DISPATCHER_SOURCES		7 // Interrupt flags STATUS_PORF (0) to STATUS_CLKF (6)
+#define DISPATCHER_QUEUE_LENGTH	8 // Events in the queue, has to be a power of 2
+#define DISPATCHER_MAX_ROUNDS	4 // Status register reads per service() call before it gives up until the next call
+
+struct RV3028_Event
+{
+	uint8_t source;			//Bit of the flag in the status register, e.g. STATUS_AF
+	unsigned long millis;	//millis() when service() read the flag
+};
+
+class RV3028_Dispatcher
+{
+public:
+
+	RV3028_Dispatcher(RV3028 &rtc);
+
+	void attachHandler(uint8_t source, void (*handler)(uint8_t source)); //source e.g. STATUS_AF
+	void detachHandler(uint8_t source);
+
+	//Call from the ISR of the INT pin, only sets the pending flag
+	void interrupt() { _pending = true; }
+	bool pending() { return _pending; }
+
+	uint8_t service(); //Reads and clears the status flags until none is left if an interrupt is pending, returns the flags
+
+	bool readEvent(RV3028_Event &event); //Takes the oldest event from the queue, false if it is empty
+	uint16_t droppedEvents(); //Events lost because the queue was full
+
+private:
+	RV3028 *_rtc;
+	volatile bool _pending;
+	void (*_handlers[DISPATCHER_SOURCES])(uint8_t source);
+
+	//Single producer (service()) single consumer (readEvent()) queue, no locks needed
+	RV3028_Event _queue[DISPATCHER_QUEUE_LENGTH];
+	volatile uint8_t _head; //Written by service() only
+	volatile uint8_t _tail; //Written by readEvent() only
+	uint16_t _dropped;
+
+	void dispatch(uint8_t flags);
+};
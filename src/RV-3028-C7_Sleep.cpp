@@ -0,0 +1,272 @@
+/******************************************************************************
+RV-3028-C7_Sleep.cpp
+RV-3028-C7 Arduino Library
+https://github.com/constiko/RV-3028_C7-Arduino_Library
+
+Development environment specifics:
+Arduino IDE 1.8.9
+
+This code is released under the [MIT License](http://opensource.org/licenses/MIT).
+Please review the LICENSE.md file included with this example. If you have any questions
+or concerns with licensing, please contact constantinkoch@outlook.com.
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#include "RV-3028-C7_Sleep.h"
+
+//Status register poll interval if no sleep hook is set
+#define SLEEP_POLL_MS 100
+
+//Timer bits of CTRL1 and interrupt enables of CTRL2 that arm() changes and disarm() restores
+#define SLEEP_CTRL1_MASK	(1 << CTRL1_TRPT | 1 << CTRL1_WADA | 1 << CTRL1_TE | 1 << CTRL1_TD1 | 1 << CTRL1_TD0)
+#define SLEEP_CTRL2_MASK	(1 << CTRL2_TIE | 1 << CTRL2_AIE)
+
+//Holds the lock of the RTC across a read-modify-write sequence
+struct SleepLock
+{
+	RV3028 *rtc;
+	SleepLock(RV3028 *owner) : rtc(owner) { rtc->lock(); }
+	~SleepLock() { rtc->unlock(); }
+};
+
+RV3028_Sleep::RV3028_Sleep(RV3028 &rtc)
+{
+	_rtc = &rtc;
+	_sleep = NULL;
+	_sleepContext = NULL;
+	_armedAt = 0;
+	_source = SLEEP_SOURCE_NONE;
+}
+
+/*********************************
+The hook has to return when the INT pin of the RTC goes low (or the MCU wakes up for another reason),
+e.g. sleep in power down mode with a LOW level interrupt on the INT pin.
+Without a hook the status register is polled every 100ms.
+*********************************/
+void RV3028_Sleep::setSleepHook(void (*sleep)(void * context), void * context)
+{
+	_sleep = sleep;
+	_sleepContext = context;
+}
+
+bool RV3028_Sleep::arm(uint32_t seconds)
+{
+	SleepLock lock(_rtc);
+	uint8_t reg[RV3028_UNIX_TIME3 + 1];
+	if (readSnapshot(reg) == false) return false;
+	return arm(reg, seconds);
+}
+
+/*********************************
+Writes back alarm, Timer Value, the timer bits of CTRL1 and TIE/AIE as they were before the first arm().
+Other bits of CTRL1 and CTRL2 keep their current value.
+*********************************/
+void RV3028_Sleep::disarm()
+{
+	if (_source == SLEEP_SOURCE_NONE) return;
+	SleepLock lock(_rtc);
+
+	//Registers 0x07 (MINUTES_ALM) to 0x10 (CTRL2)
+	uint8_t reg[sizeof(_saved)];
+	if (_rtc->readMultipleRegisters(RV3028_MINUTES_ALM, reg, sizeof(reg)) == false) return;
+	uint8_t ctrl1 = reg[RV3028_CTRL1 - RV3028_MINUTES_ALM];
+	uint8_t ctrl2 = reg[RV3028_CTRL2 - RV3028_MINUTES_ALM];
+
+	//Timer Value and alarm may only be changed while the timer is stopped and the interrupts are disabled
+	if ((ctrl1 & 1 << CTRL1_TE) || (ctrl2 & SLEEP_CTRL2_MASK))
+	{
+		uint8_t ctrl[2] = { (uint8_t)(ctrl1 & ~(1 << CTRL1_TE)), (uint8_t)(ctrl2 & ~SLEEP_CTRL2_MASK) };
+		if (_rtc->writeMultipleRegisters(RV3028_CTRL1, ctrl, 2) == false) return;
+	}
+
+	//Alarm and Timer Value, Timer Status is read only
+	memcpy(reg, _saved, RV3028_TIMERVAL_1 - RV3028_MINUTES_ALM + 1);
+	reg[RV3028_STATUS - RV3028_MINUTES_ALM] = 0xFF; //Writing 1 to a flag has no effect
+	reg[RV3028_CTRL1 - RV3028_MINUTES_ALM] = (ctrl1 & ~SLEEP_CTRL1_MASK) | (_saved[RV3028_CTRL1 - RV3028_MINUTES_ALM] & SLEEP_CTRL1_MASK);
+	reg[RV3028_CTRL2 - RV3028_MINUTES_ALM] = (ctrl2 & ~SLEEP_CTRL2_MASK) | (_saved[RV3028_CTRL2 - RV3028_MINUTES_ALM] & SLEEP_CTRL2_MASK);
+	if (_rtc->writeMultipleRegisters(RV3028_MINUTES_ALM, reg, sizeof(reg)) == false) return;
+	_source = SLEEP_SOURCE_NONE;
+}
+
+uint8_t RV3028_Sleep::sleepFor(uint32_t seconds)
+{
+	uint8_t reg[RV3028_UNIX_TIME3 + 1];
+	if (readSnapshot(reg) == false) return SLEEP_WAKE_ERROR;
+	uint32_t now = ((uint32_t)reg[RV3028_UNIX_TIME3] << 24) | ((uint32_t)reg[RV3028_UNIX_TIME2] << 16)
+		| ((uint32_t)reg[RV3028_UNIX_TIME1] << 8) | reg[RV3028_UNIX_TIME0];
+	return sleepUntil(now + seconds);
+}
+
+/*********************************
+Sleeps until the UNIX Time of the RTC reaches epoch. The timer with 1/60Hz and the alarm only have a
+resolution of one minute, so they wake up to a minute early and the rest is slept with the 1Hz timer.
+The date alarm repeats every month, so spans longer than SLEEP_ALARM_MAX are slept with several alarms.
+Returns SLEEP_WAKE_TIMER or SLEEP_WAKE_ALARM when epoch was reached, SLEEP_WAKE_NONE if it was already
+reached before, or the cause if something else woke the MCU before. The wake source is disarmed.
+*********************************/
+uint8_t RV3028_Sleep::sleepUntil(uint32_t epoch)
+{
+	uint8_t cause = SLEEP_WAKE_NONE;
+	uint8_t reg[RV3028_UNIX_TIME3 + 1];
+
+	while (true)
+	{
+		{
+			SleepLock lock(_rtc); //Timer and alarm must not change between snapshot and arm, not held while sleeping
+			if (readSnapshot(reg) == false)
+			{
+				cause = SLEEP_WAKE_ERROR;
+				break;
+			}
+			uint32_t now = ((uint32_t)reg[RV3028_UNIX_TIME3] << 24) | ((uint32_t)reg[RV3028_UNIX_TIME2] << 16)
+				| ((uint32_t)reg[RV3028_UNIX_TIME1] << 8) | reg[RV3028_UNIX_TIME0];
+			if ((int32_t)(epoch - now) <= 0) break;
+
+			if (arm(reg, epoch - now) == false)
+			{
+				cause = SLEEP_WAKE_ERROR;
+				break;
+			}
+		}
+
+		if (_sleep != NULL)
+		{
+			_sleep(_sleepContext);
+			cause = wakeCause();
+		}
+		else
+		{
+			while ((cause = wakeCause()) == SLEEP_WAKE_NONE) delay(SLEEP_POLL_MS);
+		}
+		if (cause != SLEEP_WAKE_TIMER && cause != SLEEP_WAKE_ALARM) break; //Woken up early
+	}
+
+	disarm();
+	return cause;
+}
+
+/*********************************
+Reads status, control and UNIX Time registers in one burst. Only flags of enabled interrupts and the
+power flags (PORF, BSF) are a wake cause and cleared, other flags stay set (e.g. EVF of the pulse counter).
+*********************************/
+uint8_t RV3028_Sleep::wakeCause(uint32_t * elapsed)
+{
+	//Registers 0x0E (STATUS) to 0x1E (UNIX_TIME3)
+	uint8_t reg[RV3028_UNIX_TIME3 - RV3028_STATUS + 1];
+	SleepLock lock(_rtc);
+	if (_rtc->readMultipleRegisters(RV3028_STATUS, reg, sizeof(reg)) == false)
+		return SLEEP_WAKE_ERROR;
+	uint8_t status = reg[0];
+	uint8_t ctrl2 = reg[RV3028_CTRL2 - RV3028_STATUS];
+
+	if (elapsed != NULL)
+	{
+		uint8_t * unix_reg = &reg[RV3028_UNIX_TIME0 - RV3028_STATUS];
+		uint32_t now = ((uint32_t)unix_reg[3] << 24) | ((uint32_t)unix_reg[2] << 16) | ((uint32_t)unix_reg[1] << 8) | unix_reg[0];
+		*elapsed = now - _armedAt;
+	}
+
+	uint8_t enabled = 1 << STATUS_PORF | 1 << STATUS_BSF;
+	if (ctrl2 & 1 << CTRL2_TIE) enabled |= 1 << STATUS_TF;
+	if (ctrl2 & 1 << CTRL2_AIE) enabled |= 1 << STATUS_AF;
+	if (ctrl2 & 1 << CTRL2_EIE) enabled |= 1 << STATUS_EVF;
+	if (ctrl2 & 1 << CTRL2_UIE) enabled |= 1 << STATUS_UF;
+	if (ctrl2 & 1 << CTRL2_CLKIE) enabled |= 1 << STATUS_CLKF;
+	uint8_t flags = status & enabled;
+	if (flags == 0) return SLEEP_WAKE_NONE;
+
+	//Writing 1 to a flag has no effect
+	_rtc->writeRegister(RV3028_STATUS, ~flags);
+
+	if (flags & (1 << STATUS_PORF | 1 << STATUS_BSF)) return SLEEP_WAKE_POWER;
+	if (flags & 1 << STATUS_TF) return SLEEP_WAKE_TIMER;
+	if (flags & 1 << STATUS_AF) return SLEEP_WAKE_ALARM;
+	if (flags & 1 << STATUS_EVF) return SLEEP_WAKE_EVENT;
+	return SLEEP_WAKE_OTHER;
+}
+
+//Registers 0x00 (SECONDS) to 0x1E (UNIX_TIME3), fits into one burst
+bool RV3028_Sleep::readSnapshot(uint8_t * reg)
+{
+	return _rtc->readMultipleRegisters(RV3028_SECONDS, reg, RV3028_UNIX_TIME3 + 1);
+}
+
+//Programs the wake source with the registers read by readSnapshot(), the lock has to be held
+bool RV3028_Sleep::arm(const uint8_t * reg, uint32_t seconds)
+{
+	_armedAt = ((uint32_t)reg[RV3028_UNIX_TIME3] << 24) | ((uint32_t)reg[RV3028_UNIX_TIME2] << 16)
+		| ((uint32_t)reg[RV3028_UNIX_TIME1] << 8) | reg[RV3028_UNIX_TIME0];
+	uint8_t ctrl1 = reg[RV3028_CTRL1];
+	uint8_t ctrl2 = reg[RV3028_CTRL2];
+
+	if (seconds == 0) return false;
+
+	//Keep timer and alarm of the application for disarm(), later arms see the values of the planner
+	if (_source == SLEEP_SOURCE_NONE)
+	{
+		memcpy(_saved, &reg[RV3028_MINUTES_ALM], sizeof(_saved));
+		_source = SLEEP_SOURCE_ALARM; //Until the wake source is known, so disarm() restores after a failed write
+	}
+
+	if (seconds <= (uint32_t)SLEEP_TIMER_MAX * 60)
+	{
+		//Countdown timer: the Timer Value may only be changed while the timer is stopped
+		if (ctrl1 & 1 << CTRL1_TE)
+		{
+			ctrl1 &= ~(1 << CTRL1_TE);
+			if (_rtc->writeRegister(RV3028_CTRL1, ctrl1) == false) return false;
+		}
+
+		uint16_t value;
+		uint8_t td;
+		if (seconds <= SLEEP_TIMER_MAX)
+		{
+			value = seconds;
+			td = TIMER_TD_1HZ;
+			_source = SLEEP_SOURCE_TIMER_1HZ;
+		}
+		else
+		{
+			value = seconds / 60; //Rounded down, the rest is slept with 1Hz
+			td = TIMER_TD_1_60HZ;
+			_source = SLEEP_SOURCE_TIMER_1_60HZ;
+		}
+
+		//Registers 0x0A (TIMERVAL_0) to 0x10 (CTRL2) in one burst, Timer Status is read only
+		uint8_t timer[RV3028_CTRL2 - RV3028_TIMERVAL_0 + 1];
+		memcpy(timer, &reg[RV3028_TIMERVAL_0], sizeof(timer));
+		timer[0] = value & 0xFF;
+		timer[1] = value >> 8;
+		timer[RV3028_STATUS - RV3028_TIMERVAL_0] = ~(1 << STATUS_TF | 1 << STATUS_AF); //Clear old timer and alarm flags
+		timer[RV3028_CTRL1 - RV3028_TIMERVAL_0] = (ctrl1 & ~(1 << CTRL1_TRPT | 1 << CTRL1_TD1 | 1 << CTRL1_TD0)) | 1 << CTRL1_TE | td; //Single mode
+		timer[RV3028_CTRL2 - RV3028_TIMERVAL_0] = (ctrl2 & ~(1 << CTRL2_AIE)) | 1 << CTRL2_TIE;
+		return _rtc->writeMultipleRegisters(RV3028_TIMERVAL_0, timer, sizeof(timer));
+	}
+
+	//Alarm on date, hour and minute of the real time. Real time and UNIX Time are independent, so the offset between them is added
+	if ((ctrl1 & 1 << CTRL1_TE) || (ctrl2 & 1 << CTRL2_TIE))
+	{
+		uint8_t ctrl[2] = { (uint8_t)(ctrl1 & ~(1 << CTRL1_TE)), (uint8_t)(ctrl2 & ~(1 << CTRL2_TIE)) };
+		if (_rtc->writeMultipleRegisters(RV3028_CTRL1, ctrl, 2) == false) return false;
+	}
+
+	RV3028_DateTime now;
+	now.seconds = _rtc->BCDtoDEC(reg[RV3028_SECONDS]);
+	now.minutes = _rtc->BCDtoDEC(reg[RV3028_MINUTES]);
+	if (ctrl2 & 1 << CTRL2_12_24)
+	{
+		now.hours = _rtc->BCDtoDEC(reg[RV3028_HOURS] & ~(1 << HOURS_AM_PM)) % 12; //12AM is 0
+		if (reg[RV3028_HOURS] & 1 << HOURS_AM_PM) now.hours += 12;
+	}
+	else
+		now.hours = _rtc->BCDtoDEC(reg[RV3028_HOURS]);
+	now.date = _rtc->BCDtoDEC(reg[RV3028_DATE]);
+	now.month = _rtc->BCDtoDEC(reg[RV3028_MONTHS]);
+	now.year = _rtc->BCDtoDEC(reg[RV3028_YEARS]) + 2000;
+
+	if (seconds > SLEEP_ALARM_MAX) seconds = SLEEP_ALARM_MAX; //The next alarm must not be a month later
+	RV3028_DateTime wake = RV3028::UNIXtoDateTime(RV3028::dateTimeToUNIX(now) + seconds);
+	RV3028_Alarm alarm = { wake.minutes, wake.hours, wake.date, false, 0, true };
+	_source = SLEEP_SOURCE_ALARM;
+	return _rtc->setAlarm(alarm);
+}
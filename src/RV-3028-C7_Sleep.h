@@ -0,0 +1,73 @@
+/******************************************************************************
+RV-3028-C7_Sleep.h
+RV-3028-C7 Arduino Library
+https://github.com/constiko/RV-3028_C7-Arduino_Library
+
+Sleep planner for the RV-3028-C7.
+sleepUntil() arms the cheapest wake source of the RTC (countdown timer for short spans,
+alarm for long ones), calls the sleep function of the platform and reports why the MCU woke up.
+
+Development environment specifics:
+Arduino IDE 1.8.9
+
+This code is released under the [MIT License](http://opensource.org/licenses/MIT).
+Please review the LICENSE.md file included with this example. If you have any questions
+or concerns with licensing, please contact constantinkoch@outlook.com.
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#pragma once
+
+#include "RV-3028-C7.h"
+
+//Wake causes returned by wakeCause(), sleepFor() and sleepUntil()
+#define SLEEP_WAKE_NONE		0 //No flag of the RTC is set (woken by something else or nothing to wait for)
+#define SLEEP_WAKE_TIMER	1 //Periodic Countdown Timer
+#define SLEEP_WAKE_ALARM	2
+#define SLEEP_WAKE_EVENT	3 //EVI pin
+#define SLEEP_WAKE_POWER	4 //Power On Reset or Backup Switchover
+#define SLEEP_WAKE_OTHER	5 //Periodic Time Update or Clock Output interrupt
+#define SLEEP_WAKE_ERROR	0xFF //Bus error
+
+//Wake sources selected by arm()
+#define SLEEP_SOURCE_NONE		0
+#define SLEEP_SOURCE_TIMER_1HZ	1 //Up to 4095 seconds
+#define SLEEP_SOURCE_TIMER_1_60HZ	2 //Up to 4095 minutes
+#define SLEEP_SOURCE_ALARM		3 //Longer spans, up to SLEEP_ALARM_MAX per arm()
+
+#define SLEEP_TIMER_MAX		4095 //12 bit Timer Value
+#define SLEEP_ALARM_MAX		(27 * 86400UL) //The date alarm repeats every month, longer spans are split
+
+//Timer Clock Frequency (TD bits in CTRL1)
+#define TIMER_TD_1HZ		0b10
+#define TIMER_TD_1_60HZ		0b11
+
+class RV3028_Sleep
+{
+public:
+
+	RV3028_Sleep(RV3028 &rtc);
+
+	//Called by sleepFor() and sleepUntil() to put the MCU to sleep until the INT pin of the RTC fires
+	void setSleepHook(void (*sleep)(void * context), void * context = NULL);
+
+	bool arm(uint32_t seconds); //Program the cheapest wake source in one burst, no sleep
+	void disarm(); //Restore timer and alarm as they were before the first arm()
+
+	uint8_t sleepFor(uint32_t seconds);
+	uint8_t sleepUntil(uint32_t epoch); //UNIX Time of the RTC
+	uint8_t wakeCause(uint32_t * elapsed = NULL); //Reads and clears the status flags, elapsed seconds since arm()
+
+	uint8_t source() { return _source; } //Wake source selected by the last arm()
+
+private:
+	RV3028 *_rtc;
+	void (*_sleep)(void * context);
+	void * _sleepContext;
+	uint32_t _armedAt; //UNIX Time of the last arm()
+	uint8_t _source;
+	uint8_t _saved[RV3028_CTRL2 - RV3028_MINUTES_ALM + 1]; //Alarm, timer and control registers before the first arm()
+
+	bool readSnapshot(uint8_t * reg);
+	bool arm(const uint8_t * reg, uint32_t seconds);
+};
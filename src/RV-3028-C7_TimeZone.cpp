@@ -0,0 +1,235 @@
+/******************************************************************************
+RV-3028-C7_TimeZone.cpp
+RV-3028-C7 Arduino Library
+https://github.com/constiko/RV-3028_C7-Arduino_Library
+
+Development environment specifics:
+Arduino IDE 1.8.9
+
+This code is released under the [MIT License](http://opensource.org/licenses/MIT).
+Please review the LICENSE.md file included with this example. If you have any questions
+or concerns with licensing, please contact constantinkoch@outlook.com.
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#include "RV-3028-C7_TimeZone.h"
+
+//****************************************************************************//
+//
+//  POSIX TZ parsing
+//
+//****************************************************************************//
+
+//Start or end of daylight saving time
+struct TimeZoneRule
+{
+	char type;		//'J': Julian day 1 to 365 without February 29th, 'D': day 0 to 365, 'M': month.week.day
+	uint16_t day;	//Day of year or weekday (0 = Sunday)
+	uint8_t month;
+	uint8_t week;	//1 to 5, 5 = last week of month
+	int32_t time;	//Local time of the transition in seconds
+};
+
+//Skips a zone name like "CET" or "<+03>", returns NULL if there is none
+static const char * parseName(const char * p)
+{
+	if (*p == '<')
+	{
+		while (*p && *p != '>') p++;
+		return *p ? p + 1 : NULL;
+	}
+
+	const char * start = p;
+	while ((*p >= 'A' && *p <= 'Z') || (*p >= 'a' && *p <= 'z')) p++;
+	return (p - start >= 3) ? p : NULL;
+}
+
+static const char * parseNumber(const char * p, uint16_t * value)
+{
+	if (*p < '0' || *p > '9') return NULL;
+
+	*value = 0;
+	while (*p >= '0' && *p <= '9') *value = *value * 10 + (*p++ - '0');
+	return p;
+}
+
+//Parses [+|-]hh[:mm[:ss]] into seconds, returns NULL on error
+static const char * parseTime(const char * p, int32_t * seconds)
+{
+	bool negative = (*p == '-');
+	if (*p == '+' || *p == '-') p++;
+
+	uint16_t hours, minutes = 0, secs = 0;
+	p = parseNumber(p, &hours);
+	if (p && *p == ':') p = parseNumber(p + 1, &minutes);
+	if (p && *p == ':') p = parseNumber(p + 1, &secs);
+	if (p == NULL) return NULL;
+
+	*seconds = (int32_t)hours * 3600 + (int32_t)minutes * 60 + secs;
+	if (negative) *seconds = -*seconds;
+	return p;
+}
+
+//Parses Jn, n or Mm.w.d with optional /time, returns NULL on error
+static const char * parseRule(const char * p, TimeZoneRule * rule)
+{
+	uint16_t value;
+
+	if (*p == 'M')
+	{
+		rule->type = 'M';
+		p = parseNumber(p + 1, &value);
+		if (p == NULL || *p != '.' || value < 1 || value > 12) return NULL;
+		rule->month = value;
+		p = parseNumber(p + 1, &value);
+		if (p == NULL || *p != '.' || value < 1 || value > 5) return NULL;
+		rule->week = value;
+		p = parseNumber(p + 1, &value);
+		if (p == NULL || value > 6) return NULL;
+		rule->day = value;
+	}
+	else
+	{
+		rule->type = 'D';
+		if (*p == 'J')
+		{
+			rule->type = 'J';
+			p++;
+		}
+		p = parseNumber(p, &value);
+		if (p == NULL || value > 365 || (rule->type == 'J' && value == 0)) return NULL;
+		rule->day = value;
+	}
+
+	rule->time = 7200; //Default 02:00:00
+	if (*p == '/') p = parseTime(p + 1, &rule->time);
+	return p;
+}
+
+//Days since 1970-01-01 of the local date the rule applies to in year
+static int32_t ruleToDays(const TimeZoneRule &rule, uint16_t year)
+{
+	int32_t firstOfYear = RV3028::daysFromDate(year, 1, 1);
+
+	if (rule.type == 'D')
+		return firstOfYear + rule.day;
+
+	if (rule.type == 'J')
+	{
+		//February 29th is never counted, J60 is always March 1st
+		bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+		return firstOfYear + rule.day - 1 + (leap && rule.day >= 60);
+	}
+
+	//Day d of week w of month m
+	int32_t firstOfMonth = RV3028::daysFromDate(year, rule.month, 1);
+	int32_t firstOfNextMonth = (rule.month == 12) ? RV3028::daysFromDate(year + 1, 1, 1) : RV3028::daysFromDate(year, rule.month + 1, 1);
+	uint8_t weekdayOfFirst = (firstOfMonth + 4) % 7; //1970-01-01 was a Thursday
+
+	int32_t days = firstOfMonth + (rule.day + 7 - weekdayOfFirst) % 7 + (rule.week - 1) * 7;
+	while (days >= firstOfNextMonth) days -= 7; //Week 5 means the last one
+	return days;
+}
+
+//****************************************************************************//
+//
+//  Time zone
+//
+//****************************************************************************//
+
+RV3028_TimeZone::RV3028_TimeZone(void)
+{
+	_stdOffset = 0;
+	_dstOffset = 0;
+	_transitionCount = 0;
+	_firstIsDST = false;
+}
+
+/*********************************
+Parse a POSIX TZ string and calculate the UTC instants of all transitions
+between standard and daylight saving time from firstYear to firstYear + years - 1
+Examples:
+"CET-1CEST,M3.5.0,M10.5.0/3"	Central Europe
+"EST5EDT,M3.2.0,M11.1.0"		US Eastern
+"AEST-10AEDT,M10.1.0,M4.1.0/3"	Australia Eastern
+"JST-9"							Japan (no daylight saving time)
+If no rule is given for daylight saving time, the US rule M3.2.0,M11.1.0 is used.
+Outside of the years of the table the state of the first or last year is kept.
+*********************************/
+bool RV3028_TimeZone::begin(const char * tz, uint16_t firstYear, uint8_t years)
+{
+	_transitionCount = 0;
+	if (tz == NULL || firstYear < 1970 || years > TIMEZONE_MAX_YEARS) return false;
+
+	//Standard time, POSIX offsets are west positive
+	const char * p = parseName(tz);
+	if (p == NULL || (p = parseTime(p, &_stdOffset)) == NULL) return false;
+	_stdOffset = -_stdOffset;
+	_dstOffset = _stdOffset;
+	if (*p == '\0') return true;
+
+	//Daylight saving time, one hour ahead of standard time if no offset is given
+	p = parseName(p);
+	if (p == NULL) return false;
+	_dstOffset = _stdOffset + 3600;
+	if (*p != ',' && *p != '\0')
+	{
+		if ((p = parseTime(p, &_dstOffset)) == NULL) return false;
+		_dstOffset = -_dstOffset;
+	}
+
+	TimeZoneRule start, end;
+	if (*p == '\0') p = ",M3.2.0,M11.1.0";
+	if (*p != ',' || (p = parseRule(p + 1, &start)) == NULL) return false;
+	if (*p != ',' || (p = parseRule(p + 1, &end)) == NULL) return false;
+	if (*p != '\0') return false;
+
+	//Start is given in standard time, end in daylight saving time
+	for (uint16_t year = firstYear; year < firstYear + years; year++)
+	{
+		uint32_t dstStart = (uint32_t)ruleToDays(start, year) * 86400UL + start.time - _stdOffset;
+		uint32_t dstEnd = (uint32_t)ruleToDays(end, year) * 86400UL + end.time - _dstOffset;
+
+		if (year == firstYear) _firstIsDST = dstStart < dstEnd;
+		_transitions[_transitionCount++] = _firstIsDST ? dstStart : dstEnd;
+		_transitions[_transitionCount++] = _firstIsDST ? dstEnd : dstStart;
+	}
+	return true;
+}
+
+//Offset of local time to UTC in seconds at utc
+int32_t RV3028_TimeZone::offset(uint32_t utc)
+{
+	return isDST(utc) ? _dstOffset : _stdOffset;
+}
+
+bool RV3028_TimeZone::isDST(uint32_t utc)
+{
+	if (_transitionCount == 0) return false;
+
+	//Binary search for the number of transitions until utc
+	uint8_t low = 0;
+	uint8_t high = _transitionCount;
+	while (low < high)
+	{
+		uint8_t mid = (low + high) / 2;
+		if (_transitions[mid] <= utc)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	//After an odd number of transitions the state is the one of the first transition
+	return ((low & 1) != 0) == _firstIsDST;
+}
+
+uint32_t RV3028_TimeZone::toLocal(uint32_t utc)
+{
+	return utc + offset(utc);
+}
+
+//The RTC has to run in UTC, call rtc.updateTime() before
+uint32_t RV3028_TimeZone::toLocal(RV3028 &rtc)
+{
+	return toLocal(RV3028::dateTimeToUNIX(rtc.getDateTime()));
+}
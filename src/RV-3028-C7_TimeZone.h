@@ -0,0 +1,44 @@
+/******************************************************************************
+RV-3028-C7_TimeZone.h
+RV-3028-C7 Arduino Library
+https://github.com/constiko/RV-3028_C7-Arduino_Library
+
+Time zone and daylight saving time conversion for an RV-3028-C7 running in UTC.
+The rule is given as POSIX TZ string, e.g. "CET-1CEST,M3.5.0,M10.5.0/3", and all
+transitions of a range of years are calculated once by begin().
+
+Development environment specifics:
+Arduino IDE 1.8.9
+
+This code is released under the [MIT License](http://opensource.org/licenses/MIT).
+Please review the LICENSE.md file included with this example. If you have any questions
+or concerns with licensing, please contact constantinkoch@outlook.com.
+Distributed as-is; no warranty is given.
+******************************************************************************/
+
+#pragma once
+
+#include "RV-3028-C7.h"
+
+#define TIMEZONE_MAX_YEARS 20 // Years of transitions kept in the table, two transitions per year
+
+class RV3028_TimeZone
+{
+public:
+
+	RV3028_TimeZone(void);
+
+	bool begin(const char * tz, uint16_t firstYear, uint8_t years = TIMEZONE_MAX_YEARS); //Parse tz and calculate the transitions from firstYear on
+
+	int32_t offset(uint32_t utc); //Offset of local time to UTC in seconds
+	bool isDST(uint32_t utc);
+	uint32_t toLocal(uint32_t utc); //Convert UNIX Time (UTC) to local time
+	uint32_t toLocal(RV3028 &rtc); //Convert the time read by rtc.updateTime() (UTC) to local time
+
+private:
+	int32_t _stdOffset;	//Standard time offset to UTC in seconds (east positive)
+	int32_t _dstOffset;	//Daylight saving time offset to UTC in seconds (east positive)
+	uint32_t _transitions[2 * TIMEZONE_MAX_YEARS]; //UTC instants of all transitions in ascending order
+	uint8_t _transitionCount;
+	bool _firstIsDST; //Transitions alternate, this is the state after the first one
+};